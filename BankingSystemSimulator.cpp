@@ -1,176 +1,2844 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <string>
 #include <iomanip> // For setprecision
 #include <limits>  // For numeric_limits
+#include <cstdint>
+#include <chrono>    // For the lookup benchmark
+#include <random>
+#include <algorithm> // For sort
+#include <atomic>
+#include <memory>    // For unique_ptr
+#include <mutex>
+#include <thread>
+#include <array>
+#include <functional>
+#include <cstdlib>   // For atoi
+#include <condition_variable>
+#include <future>
+#include <numeric>   // For iota
+#include <cmath>     // For pow in the Zipf generator
+#include <cstring>   // For memcpy
+#include <cstdio>    // For remove
+#include <cerrno>    // For EINTR from write
+#include <fcntl.h>   // POSIX open / fdatasync for the write-ahead log
+#include <sys/mman.h> // mmap for loading snapshots
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
+// Account kinds, as recorded in the transaction log
+enum class AccountType : uint8_t { Savings = 1, Checking = 2 };
+
+// Interest is balance * rate, rounded, then added and rounded again. Code
+// that posts interest keeps the multiply and add separate (no FMA) so every
+// path, scalar or vector, gives bit-identical balances.
+#define NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+
+// === Transaction Events ===
+// Accounts report what happened to them (deposits, withdrawals, refusals,
+// interest) as small fixed-size records instead of writing to cout. A
+// record is pushed onto a lock-free ring buffer and a background thread
+// hands batches of them to the current sink, so a transaction never waits
+// on formatting or I/O. Sinks format records as the console messages
+// (the default) or write them as packed binary; silent mode drops them.
+struct TransactionEvent {
+    enum Kind : uint8_t { Deposited = 1, DepositRejected, Withdrawn, WithdrawRejected, InterestPosted };
+
+    Kind kind;
+    AccountType accountType;
+    uint16_t reserved = 0;
+    int32_t account;
+    double amount;
+    double balance; // after the transaction
+};
+
+static_assert(sizeof(TransactionEvent) == 24, "event records are written as-is");
+
+class EventSink {
+public:
+    virtual ~EventSink() {}
+    virtual void write(const TransactionEvent* events, size_t count) = 0;
+};
+
+// The messages accounts used to print. A batch is formatted into one
+// buffer and written with a single call, leaving the stream's own
+// formatting state alone for other threads.
+class TextEventSink : public EventSink {
+private:
+    ostream& out;
+    string text;
+
+    void money(const char* label, double value) {
+        char digits[64];
+        snprintf(digits, sizeof(digits), "%.2f\n", value);
+        text += label;
+        text += digits;
+    }
+
+public:
+    explicit TextEventSink(ostream& stream) : out(stream) {}
+
+    void write(const TransactionEvent* events, size_t count) override {
+        text.clear();
+        for (size_t i = 0; i < count; i++) {
+            const TransactionEvent& e = events[i];
+            bool savings = e.accountType == AccountType::Savings;
+            switch (e.kind) {
+                case TransactionEvent::Deposited:
+                    money("Deposited: $", e.amount);
+                    money("New Balance: $", e.balance);
+                    break;
+                case TransactionEvent::DepositRejected:
+                    text += "Invalid deposit amount.\n";
+                    break;
+                case TransactionEvent::Withdrawn:
+                    money("Withdrawn: $", e.amount);
+                    if (!savings && e.balance < 0) text += "Notice: You are using overdraft.\n";
+                    money(savings ? "Remaining Balance: $" : "New Balance: $", e.balance);
+                    break;
+                case TransactionEvent::WithdrawRejected:
+                    text += savings ? "Transaction failed: Insufficient funds.\n"
+                                    : "Transaction failed: Exceeds overdraft limit.\n";
+                    break;
+                case TransactionEvent::InterestPosted:
+                    money("Interest Applied: $", e.amount);
+                    money("New Balance: $", e.balance);
+                    break;
+            }
+        }
+        out.write(text.data(), (streamsize)text.size());
+        out.flush();
+    }
+};
+
+// Packed 24-byte records appended to a file descriptor
+class BinaryEventSink : public EventSink {
+private:
+    int fd;
+
+public:
+    explicit BinaryEventSink(int descriptor) : fd(descriptor) {}
+
+    void write(const TransactionEvent* events, size_t count) override {
+        const char* p = reinterpret_cast<const char*>(events);
+        size_t left = count * sizeof(TransactionEvent);
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n <= 0) return;
+            p += n;
+            left -= (size_t)n;
+        }
+    }
+};
+
+class EventStream {
+private:
+    static const size_t CAPACITY = 1 << 16; // power of two
+
+    // Bounded multi-producer ring (Vyukov): a cell's sequence number says
+    // whether it is free for the producer at that position or holds a
+    // record for the consumer, so producers only contend on the tail CAS.
+    struct Cell {
+        atomic<uint64_t> sequence;
+        TransactionEvent event;
+    };
+
+    unique_ptr<Cell[]> cells;
+    alignas(64) atomic<uint64_t> tail{0}; // next position to claim
+    alignas(64) uint64_t head = 0;        // next position to read (writer thread only)
+    alignas(64) atomic<uint64_t> drained{0};
+    atomic<bool> sleeping{false};
+    atomic<bool> silent{false};
+    atomic<bool> stopping{false};
+
+    mutex sinkLock; // held by the writer while it uses the sink
+    unique_ptr<EventSink> sink;
+    thread writer;
+
+    // The writer sets sleeping and then re-checks the ring; a producer
+    // stores its record and then checks sleeping. All four are seq_cst, so
+    // at least one side sees the other and no record is left unwritten.
+    void wakeWriter() {
+        if (sleeping.load() && sleeping.exchange(false)) sleeping.notify_one();
+    }
+
+    size_t take(TransactionEvent* batch, size_t max) {
+        size_t n = 0;
+        while (n < max) {
+            Cell& cell = cells[head & (CAPACITY - 1)];
+            if (cell.sequence.load(memory_order_acquire) != head + 1) break;
+            batch[n++] = cell.event;
+            cell.sequence.store(head + CAPACITY, memory_order_release);
+            head++;
+        }
+        return n;
+    }
+
+    void writeLoop() {
+        vector<TransactionEvent> batch(4096);
+        while (true) {
+            size_t n = take(batch.data(), batch.size());
+            if (n > 0) {
+                {
+                    lock_guard<mutex> lock(sinkLock);
+                    if (sink) sink->write(batch.data(), n);
+                }
+                drained.fetch_add(n, memory_order_release);
+                drained.notify_all();
+                continue;
+            }
+            if (stopping.load()) return;
+            sleeping.store(true);
+            if (cells[head & (CAPACITY - 1)].sequence.load() == head + 1 || stopping.load()) {
+                sleeping.store(false);
+                continue;
+            }
+            sleeping.wait(true);
+        }
+    }
+
+public:
+    EventStream() : cells(new Cell[CAPACITY]), sink(make_unique<TextEventSink>(cout)) {
+        for (size_t i = 0; i < CAPACITY; i++) cells[i].sequence.store(i, memory_order_relaxed);
+        writer = thread(&EventStream::writeLoop, this);
+    }
+
+    ~EventStream() {
+        stopping = true;
+        sleeping = false;
+        sleeping.notify_one();
+        writer.join();
+    }
+
+    // Queue a record; spins (yielding) only if the writer is a full ring behind
+    void publish(const TransactionEvent& event) {
+        if (silent.load(memory_order_relaxed)) return;
+        uint64_t pos = tail.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & (CAPACITY - 1)];
+            uint64_t sequence = cell.sequence.load(memory_order_acquire);
+            if (sequence == pos) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.event = event;
+                    cell.sequence.store(pos + 1);
+                    break;
+                }
+            } else if (sequence < pos + 1) {
+                this_thread::yield(); // full
+                wakeWriter();
+                pos = tail.load(memory_order_relaxed);
+            } else {
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+        wakeWriter();
+    }
+
+    // Wait until every record published so far has reached the sink
+    void flush() {
+        uint64_t target = tail.load();
+        wakeWriter();
+        uint64_t done;
+        while ((done = drained.load(memory_order_acquire)) < target) drained.wait(done);
+    }
+
+    // Replace the sink (nullptr discards records) once queued ones are written
+    void setSink(unique_ptr<EventSink> next) {
+        flush();
+        lock_guard<mutex> lock(sinkLock);
+        sink = move(next);
+    }
+
+    // Silent mode: publish() returns at once without queueing anything
+    void setSilent(bool on) {
+        silent = on;
+    }
+};
+
+// The stream all accounts report to
+EventStream& events() {
+    static EventStream stream;
+    return stream;
+}
+
+void publishEvent(TransactionEvent::Kind kind, AccountType type, int account, double amount, double balance) {
+    events().publish({kind, type, 0, account, amount, balance});
+}
+
 // === Abstract Base Class: Account ===
 class Account {
 protected:
+    AccountType kind;
     int accountNumber;
     string holderName;
     double balance;
 
 public:
-    Account(int accNum, string name, double bal) 
-        : accountNumber(accNum), holderName(name), balance(bal) {}
+    Account(AccountType type, int accNum, string name, double bal) 
+        : kind(type), accountNumber(accNum), holderName(name), balance(bal) {}
+
+    virtual ~Account() {}
+
+    int getAccountNumber() const { return accountNumber; }
+    string getHolderName() const { return holderName; }
+    double getBalance() const { return balance; }
+
+    // Silent core of deposit(), used by the transaction engine
+    bool credit(double amount) {
+        if (amount <= 0) return false;
+        balance += amount;
+        return true;
+    }
+
+    // Silent core of withdraw(): applies this account type's withdrawal rule
+    virtual bool debit(double amount) = 0;
+
+    // debit() without a virtual call, for the transaction engine
+    inline bool applyDebit(double amount);
+
+    // withdraw() without a virtual call: applyDebit() plus the outcome event
+    inline bool applyWithdraw(double amount);
+
+    AccountType type() const { return kind; }
+    // Interest rate (Savings) or overdraft limit (Checking)
+    virtual double terms() const = 0;
+
+    // Concrete method for deposit (same for all accounts)
+    bool deposit(double amount) {
+        if (credit(amount)) {
+            publishEvent(TransactionEvent::Deposited, kind, accountNumber, amount, balance);
+            return true;
+        } else {
+            publishEvent(TransactionEvent::DepositRejected, kind, accountNumber, amount, balance);
+            return false;
+        }
+    }
+
+    // Pure virtual method for withdrawal (implementation varies)
+    virtual bool withdraw(double amount) = 0;
+
+    // Virtual display method
+    virtual void display() const {
+        cout << "Acc #: " << accountNumber << " | Holder: " << holderName 
+             << " | Balance: $" << fixed << setprecision(2) << balance;
+    }
+};
+
+// === Derived Class: SavingsAccount ===
+class SavingsAccount final : public Account {
+private:
+    double interestRate; // Annual interest rate (e.g., 0.05 for 5%)
+
+public:
+    SavingsAccount(int accNum, string name, double bal, double rate) 
+        : Account(AccountType::Savings, accNum, name, bal), interestRate(rate) {}
+
+    // No overdraft: the balance may not go below zero
+    bool debit(double amount) override {
+        if (amount > 0 && balance >= amount) {
+            balance -= amount;
+            return true;
+        }
+        return false;
+    }
+
+    bool withdraw(double amount) override {
+        if (debit(amount)) {
+            publishEvent(TransactionEvent::Withdrawn, kind, accountNumber, amount, balance);
+            return true;
+        } else {
+            publishEvent(TransactionEvent::WithdrawRejected, kind, accountNumber, amount, balance);
+            return false;
+        }
+    }
+
+    double terms() const override { return interestRate; }
+
+    // Silent core of applyInterest(); returns the interest posted
+    NO_FP_CONTRACT double postInterest() {
+        double interest = balance * interestRate;
+        balance += interest;
+        return interest;
+    }
+
+    // For batch posting (see Bank::postInterestLocked): the balance an
+    // interest kernel computed from this account's balance and rate
+    void setPostedBalance(double posted) { balance = posted; }
+
+    void applyInterest() {
+        double interest = postInterest();
+        publishEvent(TransactionEvent::InterestPosted, kind, accountNumber, interest, balance);
+    }
+
+    void display() const override {
+        Account::display();
+        cout << " | Type: Savings | Rate: " << (interestRate * 100) << "%" << endl;
+    }
+};
+
+// === Derived Class: CheckingAccount ===
+class CheckingAccount final : public Account {
+private:
+    double overdraftLimit; // Amount allowed to overdraw
+
+public:
+    CheckingAccount(int accNum, string name, double bal, double limit) 
+        : Account(AccountType::Checking, accNum, name, bal), overdraftLimit(limit) {}
+
+    // The balance may go as far below zero as the overdraft limit
+    bool debit(double amount) override {
+        if (amount > 0 && (balance + overdraftLimit) >= amount) {
+            balance -= amount;
+            return true;
+        }
+        return false;
+    }
+
+    bool withdraw(double amount) override {
+        if (debit(amount)) {
+            publishEvent(TransactionEvent::Withdrawn, kind, accountNumber, amount, balance);
+            return true;
+        } else {
+            publishEvent(TransactionEvent::WithdrawRejected, kind, accountNumber, amount, balance);
+            return false;
+        }
+    }
+
+    double terms() const override { return overdraftLimit; }
+
+    void display() const override {
+        Account::display();
+        cout << " | Type: Checking | Overdraft Limit: $" << overdraftLimit << endl;
+    }
+};
+
+// The type tag names the concrete class and both classes are final, so
+// each branch is a direct call the compiler can inline
+inline bool Account::applyDebit(double amount) {
+    if (kind == AccountType::Savings) return static_cast<SavingsAccount*>(this)->SavingsAccount::debit(amount);
+    return static_cast<CheckingAccount*>(this)->CheckingAccount::debit(amount);
+}
+
+inline bool Account::applyWithdraw(double amount) {
+    bool ok = applyDebit(amount);
+    publishEvent(ok ? TransactionEvent::Withdrawn : TransactionEvent::WithdrawRejected,
+                 kind, accountNumber, amount, balance);
+    return ok;
+}
+
+// === Account Pool ===
+// Accounts are constructed in place in chunks of equal-sized slots rather
+// than each by its own new, so accounts opened together sit together in
+// memory with no allocator headers between them. Chunks never move, so an
+// Account* stays valid for the pool's lifetime. Not thread-safe: the Bank
+// creates accounts under its openings lock.
+class AccountPool {
+private:
+    static const size_t CHUNK_SLOTS = 4096;
+
+    struct alignas(max(alignof(SavingsAccount), alignof(CheckingAccount))) Slot {
+        unsigned char bytes[max(sizeof(SavingsAccount), sizeof(CheckingAccount))];
+    };
+
+    vector<unique_ptr<Slot[]>> chunks;
+    vector<Account*> created; // for destruction
+    size_t used = 0;          // slots handed out
+
+public:
+    AccountPool() = default;
+    AccountPool(const AccountPool&) = delete;
+    AccountPool& operator=(const AccountPool&) = delete;
+
+    ~AccountPool() {
+        for (Account* acc : created) acc->~Account();
+    }
+
+    void reserve(size_t n) {
+        while (chunks.size() * CHUNK_SLOTS < n) chunks.push_back(make_unique<Slot[]>(CHUNK_SLOTS));
+        created.reserve(n);
+    }
+
+    Account* create(AccountType type, int accNum, const string& holder, double balance, double terms) {
+        if (used == chunks.size() * CHUNK_SLOTS) chunks.push_back(make_unique<Slot[]>(CHUNK_SLOTS));
+        void* slot = chunks[used / CHUNK_SLOTS][used % CHUNK_SLOTS].bytes;
+        Account* acc;
+        if (type == AccountType::Savings) acc = new (slot) SavingsAccount(accNum, holder, balance, terms);
+        else acc = new (slot) CheckingAccount(accNum, holder, balance, terms);
+        used++;
+        created.push_back(acc);
+        return acc;
+    }
+
+    size_t size() const { return used; }
+};
+
+// === Account Index ===
+// Open-addressing hash table from account number to Account*, so a lookup
+// is O(1) instead of a scan over every account. Linear probing over a
+// power-of-two table of (number, pointer) slots keeps each probe sequence
+// within a cache line or two; the table doubles whenever it is half full.
+// Accounts are never removed, so no tombstones are needed.
+// Lookups never lock: inserts are serialized by a mutex and publish each
+// slot by storing its pointer last, and a grown table is filled before it
+// replaces the current one. Replaced tables stay allocated (at most the
+// size of the live one in total) since a reader may still be probing them.
+class AccountIndex {
+private:
+    struct Slot {
+        int key;
+        atomic<Account*> account{nullptr}; // nullptr marks an empty slot
+    };
+
+    struct Table {
+        unique_ptr<Slot[]> slots;
+        size_t mask;
+        int shift; // 64 - log2(table size)
+
+        explicit Table(size_t capacity) : slots(new Slot[capacity]), mask(capacity - 1), shift(64) {
+            while (((size_t)1 << (64 - shift)) < capacity) shift--;
+        }
+
+        // Fibonacci hashing: the top bits of key * 2^64/phi, which spreads
+        // consecutive account numbers evenly over the table
+        size_t home(int key) const {
+            return (size_t)(((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+
+        Account* find(int key) const {
+            for (size_t i = home(key);; i = (i + 1) & mask) {
+                Account* acc = slots[i].account.load(memory_order_acquire);
+                if (acc == nullptr) return nullptr;
+                if (slots[i].key == key) return acc;
+            }
+        }
+
+        void place(int key, Account* account) {
+            size_t i = home(key);
+            while (slots[i].account.load(memory_order_relaxed)) i = (i + 1) & mask;
+            slots[i].key = key;
+            slots[i].account.store(account, memory_order_release);
+        }
+    };
+
+    atomic<Table*> current{nullptr};
+    vector<unique_ptr<Table>> tables; // every table built so far, the live one last
+    mutex writeLock;
+    size_t count = 0;
+
+    // Build a larger table off to the side, then switch readers over to it
+    void grow(size_t capacity) {
+        auto table = make_unique<Table>(capacity);
+        if (!tables.empty()) {
+            const Table& old = *tables.back();
+            for (size_t i = 0; i <= old.mask; i++) {
+                Account* acc = old.slots[i].account.load(memory_order_relaxed);
+                if (acc) table->place(old.slots[i].key, acc);
+            }
+        }
+        current.store(table.get(), memory_order_release);
+        tables.push_back(move(table));
+    }
+
+public:
+    AccountIndex() { grow(16); }
+
+    Account* find(int key) const {
+        return current.load(memory_order_acquire)->find(key);
+    }
+
+    // Returns false (and stores nothing) if the number is already taken
+    bool insert(int key, Account* account) {
+        lock_guard<mutex> lock(writeLock);
+        if (find(key)) return false;
+        if ((count + 1) * 2 > tables.back()->mask + 1) grow((tables.back()->mask + 1) * 2);
+        tables.back()->place(key, account);
+        count++;
+        return true;
+    }
+
+    // Size the table for n accounts up front, avoiding rehashes while loading
+    void reserve(size_t n) {
+        lock_guard<mutex> lock(writeLock);
+        size_t capacity = tables.back()->mask + 1;
+        while (capacity < n * 2) capacity *= 2;
+        if (capacity != tables.back()->mask + 1) grow(capacity);
+    }
+
+    size_t size() const { return count; }
+};
+
+// === Write-Ahead Log ===
+// Every change to the bank (account opening, deposit, withdrawal, transfer)
+// is appended to a log file before the caller is told it succeeded, so the
+// state can be rebuilt after a crash by replaying the log from the start.
+//
+// Each record is framed as [payload length u32][CRC-32 of payload u32]
+// followed by the payload; a torn or corrupt record ends the log. Records
+// carry a log sequence number (LSN) that grows by one per record.
+//
+// Group commit: appends only copy the record into a memory buffer. One
+// background thread writes the buffer and calls fdatasync for up to
+// batchSize records at a time, and waits up to flushInterval for a batch
+// to fill, so a single sync makes many concurrent transactions durable.
+struct LogRecord {
+    enum Kind : uint8_t { Open = 1, Deposit = 2, Withdraw = 3, Transfer = 4, Interest = 5 };
+
+    uint64_t lsn = 0;
+    Kind kind = Deposit;
+    int32_t account = 0;
+    int32_t toAccount = 0;     // Transfer destination
+    double amount = 0;         // opening balance for Open
+    AccountType accountType = AccountType::Savings; // Open only
+    double terms = 0;          // Open only: rate or overdraft limit
+    string holder;             // Open only
+};
+
+namespace walformat {
+    // CRC-32 of data; pass a previous result as seed to continue it over more bytes
+    uint32_t crc32(const char* data, size_t n, uint32_t seed = 0) {
+        static const auto table = [] {
+            array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        uint32_t c = seed ^ 0xFFFFFFFFu;
+        for (size_t i = 0; i < n; i++) c = table[(c ^ (uint8_t)data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    template <class T>
+    void put(string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    bool get(const char*& p, const char* end, T& value) {
+        if ((size_t)(end - p) < sizeof(T)) return false;
+        memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    // Append one framed record to out
+    void encode(const LogRecord& r, string& out) {
+        string payload;
+        put(payload, r.lsn);
+        put(payload, (uint8_t)r.kind);
+        put(payload, r.account);
+        put(payload, r.toAccount);
+        put(payload, r.amount);
+        if (r.kind == LogRecord::Open) {
+            put(payload, (uint8_t)r.accountType);
+            put(payload, r.terms);
+            put(payload, (uint16_t)r.holder.size());
+            payload += r.holder;
+        }
+        put(out, (uint32_t)payload.size());
+        put(out, crc32(payload.data(), payload.size()));
+        out += payload;
+    }
+
+    // Decode the framed record at p; false at the end of the valid log
+    bool decode(const char*& p, const char* end, LogRecord& r) {
+        const char* q = p;
+        uint32_t length, crc;
+        if (!get(q, end, length) || !get(q, end, crc)) return false;
+        if ((size_t)(end - q) < length || crc32(q, length) != crc) return false;
+        const char* payloadEnd = q + length;
+        uint8_t kind;
+        if (!get(q, payloadEnd, r.lsn) || !get(q, payloadEnd, kind) || !get(q, payloadEnd, r.account)
+            || !get(q, payloadEnd, r.toAccount) || !get(q, payloadEnd, r.amount)) {
+            return false;
+        }
+        r.kind = (LogRecord::Kind)kind;
+        if (r.kind == LogRecord::Open) {
+            uint8_t type;
+            uint16_t nameLength;
+            if (!get(q, payloadEnd, type) || !get(q, payloadEnd, r.terms) || !get(q, payloadEnd, nameLength)
+                || (size_t)(payloadEnd - q) < nameLength) {
+                return false;
+            }
+            r.accountType = (AccountType)type;
+            r.holder.assign(q, nameLength);
+        }
+        p = payloadEnd;
+        return true;
+    }
+
+    // Read bytes [from, from + n) of an open file
+    string readRange(int fd, uint64_t from, uint64_t n) {
+        string data(n, '\0');
+        size_t done = 0;
+        while (done < n) {
+            ssize_t got = ::pread(fd, data.data() + done, n - done, (off_t)(from + done));
+            if (got <= 0) break;
+            done += (size_t)got;
+        }
+        data.resize(done);
+        return data;
+    }
+}
+
+class WriteAheadLog {
+public:
+    struct Options {
+        chrono::microseconds flushInterval{2000}; // longest a commit waits for its batch to fill
+        size_t batchSize = 256;                   // most records per fdatasync
+    };
+
+private:
+    int fd = -1;
+    Options options;
+
+    mutex mtx;
+    condition_variable flushWake;
+    condition_variable durableWake;
+    string pending;                            // encoded records not yet written
+    vector<pair<size_t, uint64_t>> pendingEnds; // (end offset in pending, lsn) per record
+    chrono::steady_clock::time_point oldestPending;
+    uint64_t nextLsn = 1;
+    uint64_t durableLsn = 0;
+    uint64_t appendedEnd = 0; // file offset just past the last appended record
+    atomic<bool> failed{false}; // a write or sync failed: nothing more becomes durable (set under mtx)
+    bool stopping = false;
+    thread flusher;
+
+    size_t syncs = 0;
+    size_t recordsWritten = 0;
+
+    void flushLoop() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            flushWake.wait(lock, [&] { return stopping || !pendingEnds.empty(); });
+            if (pendingEnds.empty()) return; // stopping with nothing left
+            flushWake.wait_until(lock, oldestPending + options.flushInterval, [&] {
+                return stopping || pendingEnds.size() >= options.batchSize;
+            });
+
+            size_t count = min(pendingEnds.size(), options.batchSize);
+            size_t bytes = pendingEnds[count - 1].first;
+            uint64_t upTo = pendingEnds[count - 1].second;
+            string batch = pending.substr(0, bytes);
+            pending.erase(0, bytes);
+            pendingEnds.erase(pendingEnds.begin(), pendingEnds.begin() + count);
+            for (auto& end : pendingEnds) end.first -= bytes;
+            oldestPending = chrono::steady_clock::now();
+
+            lock.unlock();
+            const char* p = batch.data();
+            size_t left = batch.size();
+            while (left > 0) {
+                ssize_t n = ::write(fd, p, left);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                p += n;
+                left -= (size_t)n;
+            }
+            bool synced = left == 0 && fdatasync(fd) == 0;
+            lock.lock();
+
+            if (!synced) {
+                // Records after a gap could never be replayed, so the log
+                // stays failed: waiters are told their changes didn't commit
+                cout << "Error: Write to transaction log failed; no further transactions can be committed." << endl;
+                failed = true;
+                pending.clear();
+                pendingEnds.clear();
+                durableWake.notify_all();
+                continue;
+            }
+            durableLsn = upTo;
+            syncs++;
+            recordsWritten += count;
+            durableWake.notify_all();
+        }
+    }
+
+public:
+    WriteAheadLog() = default;
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog() { close(); }
+
+    // Open path for appending; firstLsn is the LSN the next record gets
+    bool open(const string& path, uint64_t firstLsn, Options opts) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) return false;
+        options = opts;
+        options.batchSize = max<size_t>(options.batchSize, 1);
+        nextLsn = firstLsn;
+        durableLsn = firstLsn - 1;
+        appendedEnd = (uint64_t)lseek(fd, 0, SEEK_END);
+        stopping = false;
+        flusher = thread(&WriteAheadLog::flushLoop, this);
+        return true;
+    }
+
+    // Write out everything appended so far and stop the flusher
+    void close() {
+        if (fd < 0) return;
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        flushWake.notify_one();
+        flusher.join();
+        ::close(fd);
+        fd = -1;
+    }
+
+    // Queue a record (its lsn is assigned here) and return that LSN. Once
+    // the log has failed the record is dropped and never becomes durable.
+    uint64_t append(LogRecord& record) {
+        lock_guard<mutex> lock(mtx);
+        record.lsn = nextLsn++;
+        if (failed) return record.lsn;
+        if (pendingEnds.empty()) oldestPending = chrono::steady_clock::now();
+        walformat::encode(record, pending);
+        appendedEnd += pending.size() - (pendingEnds.empty() ? 0 : pendingEnds.back().first);
+        pendingEnds.push_back({pending.size(), record.lsn});
+        // Wake the flusher to start the interval timer, or because a batch is full
+        if (pendingEnds.size() == 1 || pendingEnds.size() >= options.batchSize) flushWake.notify_one();
+        return record.lsn;
+    }
+
+    // Block until the record with this LSN is on disk; false if the log
+    // failed before it got there
+    bool waitDurable(uint64_t lsn) {
+        unique_lock<mutex> lock(mtx);
+        durableWake.wait(lock, [&] { return durableLsn >= lsn || failed; });
+        return durableLsn >= lsn;
+    }
+
+    // LSN of the last record known to be on disk
+    uint64_t durableUpTo() {
+        lock_guard<mutex> lock(mtx);
+        return durableLsn;
+    }
+
+    // Lock-free, so the bank can check it on every transaction
+    bool hasFailed() const {
+        return failed.load(memory_order_acquire);
+    }
+
+    uint64_t lastLsn() {
+        lock_guard<mutex> lock(mtx);
+        return nextLsn - 1;
+    }
+
+    // LSN of the last record appended, and the file offset just past it
+    pair<uint64_t, uint64_t> position() {
+        lock_guard<mutex> lock(mtx);
+        return {nextLsn - 1, appendedEnd};
+    }
+
+    size_t syncCount() {
+        lock_guard<mutex> lock(mtx);
+        return syncs;
+    }
+
+    size_t recordCount() {
+        lock_guard<mutex> lock(mtx);
+        return recordsWritten;
+    }
+
+    // Read every valid record of the log at path with an LSN above
+    // afterLsn, in order. A torn or corrupt tail (from a crash mid-write) is
+    // cut off so later appends follow valid data. fromOffset is where a
+    // snapshot says record afterLsn + 1 starts: reading begins there if it
+    // checks out, and at the start of the file otherwise. Returns the number
+    // of records applied.
+    static size_t replay(const string& path, const function<void(const LogRecord&)>& apply,
+                         uint64_t fromOffset = 0, uint64_t afterLsn = 0) {
+        int in = ::open(path.c_str(), O_RDWR);
+        if (in < 0) return 0;
+        struct stat st;
+        uint64_t size = fstat(in, &st) == 0 ? (uint64_t)st.st_size : 0;
+
+        uint64_t start = 0;
+        if (fromOffset > 0 && fromOffset <= size) {
+            string head = walformat::readRange(in, fromOffset, min<uint64_t>(size - fromOffset, 1 << 17));
+            const char* p = head.data();
+            LogRecord first;
+            if (head.empty() || (walformat::decode(p, p + head.size(), first) && first.lsn == afterLsn + 1)) {
+                start = fromOffset;
+            }
+        }
+        string data = walformat::readRange(in, start, size - start);
+
+        const char* p = data.data();
+        const char* end = p + data.size();
+        size_t count = 0;
+        LogRecord record;
+        while (walformat::decode(p, end, record)) {
+            if (record.lsn <= afterLsn) continue;
+            apply(record);
+            count++;
+        }
+        size_t valid = (size_t)(p - data.data());
+        if (valid < data.size()) {
+            cout << "Transaction log: discarded " << data.size() - valid << " bytes of incomplete records." << endl;
+            if (ftruncate(in, (off_t)(start + valid)) != 0) cout << "Error: Cannot truncate transaction log." << endl;
+        }
+        ::close(in);
+        return count;
+    }
+};
+
+// === Checkpoint Snapshots ===
+// A snapshot is every account at one point in the log, so a restart loads
+// it and replays only the log records after that point. File layout:
+//   header   magic, LSN and log offset it was taken at, account count,
+//            name bytes, and a CRC of everything after the header
+//   entries  one fixed-size SnapshotEntry per account
+//   names    holder names, referenced by offset from the entries
+// Snapshots are written to a temporary file and renamed into place, so a
+// crash mid-write leaves the previous snapshot intact.
+struct SnapshotHeader {
+    char magic[8];
+    uint64_t lsn;        // last log record reflected in the snapshot
+    uint64_t logOffset;  // where the record after it starts in the log
+    uint64_t count;
+    uint64_t nameBytes;
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+struct SnapshotEntry {
+    int32_t accountNumber;
+    uint8_t accountType;
+    uint8_t padding[3];
+    double balance;
+    double terms;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+static_assert(sizeof(SnapshotHeader) == 48 && sizeof(SnapshotEntry) == 32, "snapshot layout is fixed");
+
+const char SNAPSHOT_MAGIC[8] = {'B', 'A', 'N', 'K', 'S', 'N', 'P', '1'};
+
+// An in-memory snapshot waiting to be written
+struct SnapshotImage {
+    uint64_t lsn = 0;
+    uint64_t logOffset = 0;
+    vector<SnapshotEntry> entries;
+    string names;
+};
+
+namespace snapshot {
+    bool writeAll(int fd, const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t done = ::write(fd, p, n);
+            if (done <= 0) return false;
+            p += done;
+            n -= (size_t)done;
+        }
+        return true;
+    }
+
+    // CRC of the entries followed by the names
+    uint32_t checksum(const char* entries, size_t entryBytes, const char* names, size_t nameBytes) {
+        return walformat::crc32(names, nameBytes, walformat::crc32(entries, entryBytes));
+    }
+
+    bool write(const string& path, const SnapshotImage& image) {
+        SnapshotHeader header{};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.lsn = image.lsn;
+        header.logOffset = image.logOffset;
+        header.count = image.entries.size();
+        header.nameBytes = image.names.size();
+        const char* entries = reinterpret_cast<const char*>(image.entries.data());
+        size_t entryBytes = image.entries.size() * sizeof(SnapshotEntry);
+        header.crc = checksum(entries, entryBytes, image.names.data(), image.names.size());
+
+        string temp = path + ".tmp";
+        int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header))
+                  && writeAll(fd, entries, entryBytes)
+                  && writeAll(fd, image.names.data(), image.names.size())
+                  && fdatasync(fd) == 0;
+        ::close(fd);
+        if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+            ::unlink(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Map the snapshot at path and call add(entry, name) for every account.
+    // Returns false, having added nothing, if there is no valid snapshot.
+    bool load(const string& path, SnapshotHeader& header,
+              const function<void(const SnapshotEntry&, const string&)>& add) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = (size_t)st.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        madvise(mapped, size, MADV_SEQUENTIAL);
+
+        const char* base = static_cast<const char*>(mapped);
+        memcpy(&header, base, sizeof(header));
+        const char* entries = base + sizeof(header);
+        size_t entryBytes = header.count * sizeof(SnapshotEntry);
+        const char* names = entries + entryBytes;
+        bool valid = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0
+                     && header.count <= size / sizeof(SnapshotEntry)
+                     && sizeof(header) + entryBytes + header.nameBytes == size
+                     && checksum(entries, entryBytes, names, header.nameBytes) == header.crc;
+        if (valid) {
+            const SnapshotEntry* entry = reinterpret_cast<const SnapshotEntry*>(entries);
+            string name;
+            for (uint64_t i = 0; i < header.count; i++) {
+                if ((uint64_t)entry[i].nameOffset + entry[i].nameLength > header.nameBytes) continue;
+                name.assign(names + entry[i].nameOffset, entry[i].nameLength);
+                add(entry[i], name);
+            }
+        }
+        munmap(mapped, size);
+        return valid;
+    }
+}
+
+// === Interest Kernels ===
+// balance += balance * rate over whole columns, in vectors of 4 (AVX2) or
+// 8 (AVX-512) doubles, plus a scalar fallback. Each kernel is compiled for
+// its instruction set with a target attribute and the best one the CPU
+// supports is picked at runtime, so the binary still runs anywhere.
+namespace interest {
+    using PostFn = void (*)(double* balances, const double* rates, size_t n);
+
+    struct Kernel {
+        string name;
+        PostFn post;
+    };
+
+    NO_FP_CONTRACT void postScalar(double* balances, const double* rates, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            double interest = balances[i] * rates[i];
+            balances[i] += interest;
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    template <int Bytes>
+    inline __attribute__((always_inline)) NO_FP_CONTRACT void postBody(double* balances, const double* rates, size_t n) {
+        typedef double V __attribute__((vector_size(Bytes)));
+        const size_t W = Bytes / sizeof(double);
+        size_t i = 0;
+        for (; i + W <= n; i += W) {
+            V b, r;
+            memcpy(&b, balances + i, Bytes);
+            memcpy(&r, rates + i, Bytes);
+            V interest = b * r;
+            b += interest;
+            memcpy(balances + i, &b, Bytes);
+        }
+        for (; i < n; i++) {
+            double interest = balances[i] * rates[i];
+            balances[i] += interest;
+        }
+    }
+
+    __attribute__((target("avx2"))) NO_FP_CONTRACT
+    void postAvx2(double* balances, const double* rates, size_t n) { postBody<32>(balances, rates, n); }
+
+    __attribute__((target("avx512f"))) NO_FP_CONTRACT
+    void postAvx512(double* balances, const double* rates, size_t n) { postBody<64>(balances, rates, n); }
+#endif
+
+    // Every kernel this CPU can run, fastest last
+    vector<Kernel> supported() {
+        vector<Kernel> kernels = {{"scalar", postScalar}};
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) kernels.push_back({"avx2", postAvx2});
+        if (__builtin_cpu_supports("avx512f")) kernels.push_back({"avx512", postAvx512});
+#endif
+        return kernels;
+    }
+
+    const Kernel& active() {
+        static const Kernel chosen = supported().back();
+        return chosen;
+    }
+
+    // Post with the given kernel, split over threads in cache-line sized
+    // chunks; small batches aren't worth a thread
+    void postParallel(const Kernel& kernel, double* balances, const double* rates, size_t n, int threads) {
+        threads = max(1, min<int>(threads, (int)(n / 8192) + 1));
+        if (threads == 1) {
+            kernel.post(balances, rates, n);
+            return;
+        }
+        vector<thread> pool;
+        for (int t = 0; t < threads; t++) {
+            size_t begin = n * t / threads / 8 * 8;
+            size_t end = t + 1 == threads ? n : n * (t + 1) / threads / 8 * 8;
+            pool.emplace_back([=] { kernel.post(balances + begin, rates + begin, end - begin); });
+        }
+        for (auto& th : pool) th.join();
+    }
+}
+
+// === Bank Management Class ===
+// Balances are guarded by striped locks: account n is protected by stripe
+// n % LOCK_STRIPES, so memory stays fixed however many accounts there are,
+// and consecutive account numbers never share a lock. Each stripe has its
+// own cache line so threads working on different accounts don't contend.
+class Bank {
+private:
+    static const int LOCK_STRIPES = 4096;
+
+    struct alignas(64) Stripe {
+        mutex lock;
+    };
+
+    AccountPool pool;          // owns the accounts
+    vector<Account*> accounts; // in opening order
+    AccountIndex index;        // account number -> account
+    mutex accountsLock;        // serializes openings
+
+    // Savings accounts in opening order with their rates alongside, plus
+    // scratch for their balances, so interest posts as one columnar batch
+    vector<SavingsAccount*> savers;
+    vector<double> saverRates;
+    vector<double> saverBalances;
+    unique_ptr<array<Stripe, LOCK_STRIPES>> stripes = make_unique<array<Stripe, LOCK_STRIPES>>();
+    WriteAheadLog* log = nullptr; // when set, every change is logged
+
+    mutex& lockFor(int accNum) {
+        return (*stripes)[(unsigned)accNum % LOCK_STRIPES].lock;
+    }
+
+    // Log a change while the locks that ordered it are still held, so the
+    // log replays changes to each account in the order they happened.
+    // Returns the record's LSN, or 0 when not logging.
+    uint64_t logChange(LogRecord::Kind kind, int accNum, int toNum, double amount) {
+        if (!log) return 0;
+        LogRecord r;
+        r.kind = kind;
+        r.account = accNum;
+        r.toAccount = toNum;
+        r.amount = amount;
+        return log->append(r);
+    }
+
+    // Log an account's opening; called before the account is published
+    uint64_t logOpen(const Account* acc) {
+        if (!log) return 0;
+        LogRecord r;
+        r.kind = LogRecord::Open;
+        r.account = acc->getAccountNumber();
+        r.amount = acc->getBalance();
+        r.accountType = acc->type();
+        r.terms = acc->terms();
+        r.holder = acc->getHolderName();
+        return log->append(r);
+    }
+
+    // Caller holds every lock (or is recovering alone). Savings balances
+    // are gathered into a column, posted with the fastest interest kernel
+    // (bit-identical to SavingsAccount::postInterest) and scattered back.
+    void postInterestLocked() {
+        size_t n = savers.size();
+        saverBalances.resize(n);
+        for (size_t i = 0; i < n; i++) saverBalances[i] = savers[i]->getBalance();
+        interest::postParallel(interest::active(), saverBalances.data(), saverRates.data(), n,
+                               (int)max(1u, thread::hardware_concurrency()));
+        for (size_t i = 0; i < n; i++) savers[i]->setPostedBalance(saverBalances[i]);
+    }
+
+public:
+    // Called after the locks are released, so other transactions can join
+    // the same group commit while this one waits. False if the log failed
+    // before the change reached disk: it is then not committed, and the
+    // caller must report it as failed.
+    bool awaitDurable(uint64_t lsn) {
+        return lsn == 0 || log->waitDurable(lsn);
+    }
+
+    // Every change with an LSN up to this one is on disk
+    uint64_t durableLsn() {
+        return log ? log->durableUpTo() : UINT64_MAX;
+    }
+
+    // Once the log has failed the bank is read-only: every change checks
+    // this under its lock before touching a balance and is refused, so the
+    // accounts never move further from what a restart would recover. A
+    // change already logged when the write failed stays applied in memory;
+    // its caller was told it didn't commit, and no later change builds on it
+    // durably.
+    bool logFailed() const {
+        return log && log->hasFailed();
+    }
+
+    // Open an account (terms is the interest rate for savings, the
+    // overdraft limit for checking); false if its number is taken, the
+    // bank is read-only, or the opening could not be logged
+    bool addAccount(AccountType type, int accNum, const string& holder, double balance, double terms) {
+        uint64_t lsn;
+        {
+            lock_guard<mutex> lock(accountsLock);
+            if (logFailed() || index.find(accNum)) return false;
+            Account* acc = pool.create(type, accNum, holder, balance, terms);
+            // Log the opening before publishing the account: until it is in
+            // the index no other thread can reach it, so its balance needs
+            // no stripe lock, and every change to it gets a later LSN than
+            // its Open record
+            lsn = logOpen(acc);
+            index.insert(accNum, acc);
+            accounts.push_back(acc);
+            if (type == AccountType::Savings) {
+                savers.push_back(static_cast<SavingsAccount*>(acc));
+                saverRates.push_back(terms);
+            }
+        }
+        return awaitDurable(lsn);
+    }
+
+    // Log every change from now on; each call returns once its change is durable
+    void attachLog(WriteAheadLog* wal) { log = wal; }
+
+    // Apply one logged change without logging it again (crash recovery)
+    bool applyLogged(const LogRecord& r) {
+        if (r.kind == LogRecord::Open) {
+            return addAccount(r.accountType, r.account, r.holder, r.amount, r.terms);
+        }
+        if (r.kind == LogRecord::Interest) {
+            postInterestLocked();
+            return true;
+        }
+        Account* acc = findAccount(r.account);
+        if (!acc) return false;
+        switch (r.kind) {
+            case LogRecord::Deposit: return acc->credit(r.amount);
+            case LogRecord::Withdraw: return acc->applyDebit(r.amount);
+            case LogRecord::Transfer: {
+                Account* to = findAccount(r.toAccount);
+                if (!to || !acc->applyDebit(r.amount)) return false;
+                return to->credit(r.amount);
+            }
+            default: return false;
+        }
+    }
+
+    // Rebuild state from the snapshot at snapshotPath (if there is a valid
+    // one) plus the log records written after it; with no snapshot path the
+    // whole log is replayed. Returns the last LSN recovered.
+    uint64_t recover(const string& logPath, const string& snapshotPath = "") {
+        SnapshotHeader header{};
+        bool loaded = !snapshotPath.empty() && snapshot::load(snapshotPath, header,
+            [&](const SnapshotEntry& e, const string& name) {
+                if (accounts.empty()) reserve(header.count);
+                addAccount((AccountType)e.accountType, e.accountNumber, name, e.balance, e.terms);
+            });
+        if (!loaded) header.lsn = header.logOffset = 0;
+        else cout << "Loaded " << header.count << " accounts from snapshot " << snapshotPath << endl;
+
+        uint64_t last = header.lsn;
+        size_t failed = 0;
+        size_t count = WriteAheadLog::replay(logPath, [&](const LogRecord& r) {
+            if (!applyLogged(r)) failed++;
+            last = r.lsn;
+        }, header.logOffset, header.lsn);
+        if (count > 0) cout << "Recovered " << count << " logged transactions from " << logPath << endl;
+        if (failed > 0) cout << "Warning: " << failed << " logged transactions could not be applied." << endl;
+        return last;
+    }
+
+    // Copy every account at one consistent point: with all locks held no
+    // change is half-applied, and the log position read then is exactly
+    // the last change the copy reflects. Transactions wait only for the
+    // copy, not for the snapshot to be written.
+    SnapshotImage captureSnapshot() {
+        SnapshotImage image;
+        for (auto& s : *stripes) s.lock.lock();
+        {
+            lock_guard<mutex> lock(accountsLock);
+            image.entries.reserve(accounts.size());
+            for (const Account* acc : accounts) {
+                SnapshotEntry e{};
+                e.accountNumber = acc->getAccountNumber();
+                e.accountType = (uint8_t)acc->type();
+                e.balance = acc->getBalance();
+                e.terms = acc->terms();
+                e.nameOffset = (uint32_t)image.names.size();
+                e.nameLength = (uint32_t)acc->getHolderName().size();
+                image.names += acc->getHolderName();
+                image.entries.push_back(e);
+            }
+            if (log) tie(image.lsn, image.logOffset) = log->position();
+        }
+        for (auto& s : *stripes) s.lock.unlock();
+        return image;
+    }
+
+    // Post one period's interest to every savings account as one columnar
+    // batch, with all locks held so the posting sits at one point in the
+    // log. It is logged as a single record: replaying it repeats the same
+    // arithmetic on the same balances.
+    bool postInterestAll() {
+        uint64_t lsn = 0;
+        for (auto& s : *stripes) s.lock.lock();
+        bool readOnly = logFailed();
+        if (!readOnly) {
+            lock_guard<mutex> lock(accountsLock);
+            postInterestLocked();
+            lsn = logChange(LogRecord::Interest, 0, 0, 0);
+        }
+        for (auto& s : *stripes) s.lock.unlock();
+        return !readOnly && awaitDurable(lsn);
+    }
+
+    // Write a snapshot to path. It is only published once the log covers
+    // it, so a restart never finds a snapshot ahead of the log.
+    bool checkpoint(const string& path) {
+        SnapshotImage image = captureSnapshot();
+        return awaitDurable(image.lsn) && snapshot::write(path, image);
+    }
+
+    int highestAccountNumber() {
+        lock_guard<mutex> lock(accountsLock);
+        int highest = 0;
+        for (const Account* acc : accounts) highest = max(highest, acc->getAccountNumber());
+        return highest;
+    }
+
+    void openAccount(AccountType type, int accNum, const string& holder, double balance, double terms) {
+        if (addAccount(type, accNum, holder, balance, terms)) {
+            cout << "Account created successfully!" << endl;
+        } else if (logFailed()) {
+            cout << "Error: Transaction log failed; the account was not saved." << endl;
+        } else {
+            cout << "Account number already exists." << endl;
+        }
+    }
+
+    void reserve(size_t n) {
+        lock_guard<mutex> lock(accountsLock);
+        pool.reserve(n);
+        accounts.reserve(n);
+        savers.reserve(n);
+        saverRates.reserve(n);
+        index.reserve(n);
+    }
+
+    size_t accountCount() const { return accounts.size(); }
+
+    Account* findAccount(int accNum) {
+        return index.find(accNum);
+    }
+
+    // The original one-account-at-a-time interest loop, kept as the
+    // reference for --bench-interest (takes every lock; not logged)
+    void postInterestEach() {
+        for (auto& s : *stripes) s.lock.lock();
+        {
+            lock_guard<mutex> lock(accountsLock);
+            for (Account* acc : accounts) {
+                if (acc->type() == AccountType::Savings) static_cast<SavingsAccount*>(acc)->postInterest();
+            }
+        }
+        for (auto& s : *stripes) s.lock.unlock();
+    }
+
+    // The original linear search, kept as the baseline for --bench-lookup
+    // (not safe while accounts are being opened)
+    Account* scanForAccount(int accNum) {
+        for (Account* acc : accounts) {
+            if (acc->getAccountNumber() == accNum) {
+                return acc;
+            }
+        }
+        return nullptr;
+    }
+
+    // --- Thread-safe transaction API ---
+    // Silent and callable from any number of threads at once. Each call
+    // holds the stripe lock of every account it touches; transfer takes
+    // both stripes in ascending order, so two opposite transfers can never
+    // wait on each other. Returns false if an account doesn't exist, the
+    // account's own rules reject the amount, or the bank is read-only
+    // (see logFailed).
+
+    bool tryDeposit(int accNum, double amount) {
+        Account* acc = findAccount(accNum);
+        if (!acc) return false;
+        uint64_t lsn;
+        {
+            lock_guard<mutex> lock(lockFor(accNum));
+            if (logFailed() || !acc->credit(amount)) return false;
+            lsn = logChange(LogRecord::Deposit, accNum, 0, amount);
+        }
+        return awaitDurable(lsn);
+    }
+
+    bool tryWithdraw(int accNum, double amount) {
+        Account* acc = findAccount(accNum);
+        if (!acc) return false;
+        uint64_t lsn;
+        {
+            lock_guard<mutex> lock(lockFor(accNum));
+            if (logFailed() || !acc->applyDebit(amount)) return false;
+            lsn = logChange(LogRecord::Withdraw, accNum, 0, amount);
+        }
+        return awaitDurable(lsn);
+    }
+
+    // Moves amount from one account to another, all or nothing
+    bool transfer(int fromNum, int toNum, double amount) {
+        uint64_t lsn = 0;
+        bool ok = transferUnawaited(fromNum, toNum, amount, lsn);
+        return awaitDurable(lsn) && ok;
+    }
+
+    // transfer() without waiting for the log: sets lsn to the change's
+    // LSN for the caller to pass to awaitDurable (left alone on failure)
+    bool transferUnawaited(int fromNum, int toNum, double amount, uint64_t& lsn) {
+        Account* from = findAccount(fromNum);
+        Account* to = findAccount(toNum);
+        if (!from || !to || from == to || amount <= 0) return false;
+
+        mutex* first = &lockFor(fromNum);
+        mutex* second = &lockFor(toNum);
+        if (first > second) swap(first, second); // stripes live in one array: address order is index order
+        unique_lock<mutex> lockFirst(*first);
+        unique_lock<mutex> lockSecond;
+        if (second != first) lockSecond = unique_lock<mutex>(*second);
+
+        if (logFailed() || !from->applyDebit(amount)) return false;
+        to->credit(amount);
+        lsn = logChange(LogRecord::Transfer, fromNum, toNum, amount);
+        return true;
+    }
+
+    // A deposit (amount > 0) or withdrawal (amount < 0) for postAll
+    struct Posting {
+        double amount;
+        bool ok = false;
+        uint64_t lsn = 0; // when logged; committed once durableLsn() reaches it
+    };
+
+    // Apply a run of postings to one account, in order, under one lock
+    // acquisition. Sets each posting's ok flag and LSN and returns the LSN
+    // of the last one logged (0 if none), for the caller to pass to
+    // awaitDurable.
+    uint64_t postAll(int accNum, Posting* postings, size_t count) {
+        Account* acc = findAccount(accNum);
+        if (!acc) return 0;
+        uint64_t lsn = 0;
+        lock_guard<mutex> lock(lockFor(accNum));
+        if (logFailed()) return 0; // read-only: every posting stays refused
+        for (size_t i = 0; i < count; i++) {
+            Posting& p = postings[i];
+            if (p.amount > 0) {
+                p.ok = acc->credit(p.amount);
+                if (p.ok) lsn = p.lsn = logChange(LogRecord::Deposit, accNum, 0, p.amount);
+            } else {
+                p.ok = acc->applyDebit(-p.amount);
+                if (p.ok) lsn = p.lsn = logChange(LogRecord::Withdraw, accNum, 0, -p.amount);
+            }
+        }
+        return lsn;
+    }
+
+    // Sum of all balances, consistent even while transactions are running
+    double totalBalance() {
+        for (auto& s : *stripes) s.lock.lock();
+        double total = 0;
+        {
+            lock_guard<mutex> lock(accountsLock);
+            for (const Account* acc : accounts) total += acc->getBalance();
+        }
+        for (auto& s : *stripes) s.lock.unlock();
+        return total;
+    }
+
+    // --- Interactive operations (print their outcome) ---
+
+    void deposit(int accNum, double amount) {
+        Account* acc = findAccount(accNum);
+        if (acc) {
+            uint64_t lsn = 0;
+            bool readOnly;
+            {
+                lock_guard<mutex> lock(lockFor(accNum));
+                readOnly = logFailed();
+                if (!readOnly && acc->deposit(amount)) lsn = logChange(LogRecord::Deposit, accNum, 0, amount);
+            }
+            if (readOnly) {
+                cout << "Error: Transaction log failed; the bank is read-only." << endl;
+                return;
+            }
+            bool committed = awaitDurable(lsn);
+            events().flush(); // show the outcome before the next prompt
+            if (!committed) cout << "Error: Transaction log failed; this change was not saved." << endl;
+        } else {
+            cout << "Account not found." << endl;
+        }
+    }
+
+    void withdraw(int accNum, double amount) {
+        Account* acc = findAccount(accNum);
+        if (acc) {
+            uint64_t lsn = 0;
+            bool readOnly;
+            {
+                lock_guard<mutex> lock(lockFor(accNum));
+                readOnly = logFailed();
+                if (!readOnly && acc->applyWithdraw(amount)) lsn = logChange(LogRecord::Withdraw, accNum, 0, amount);
+            }
+            if (readOnly) {
+                cout << "Error: Transaction log failed; the bank is read-only." << endl;
+                return;
+            }
+            bool committed = awaitDurable(lsn);
+            events().flush(); // show the outcome before the next prompt
+            if (!committed) cout << "Error: Transaction log failed; this change was not saved." << endl;
+        } else {
+            cout << "Account not found." << endl;
+        }
+    }
+
+    void transferFunds(int fromNum, int toNum, double amount) {
+        if (!findAccount(fromNum) || !findAccount(toNum)) {
+            cout << "Account not found." << endl;
+        } else if (transfer(fromNum, toNum, amount)) {
+            cout << "Transferred: $" << fixed << setprecision(2) << amount
+                 << " from #" << fromNum << " to #" << toNum << endl;
+        } else if (logFailed()) {
+            cout << "Error: Transaction log failed; the transfer was not saved." << endl;
+        } else {
+            cout << "Transfer failed: invalid amount, same account, or insufficient funds." << endl;
+        }
+    }
+
+    void displayAll() {
+        if (accounts.empty()) {
+            cout << "No accounts to display." << endl;
+            return;
+        }
+        cout << "\n--- All Bank Accounts ---" << endl;
+        for (const auto& acc : accounts) {
+            acc->display();
+        }
+    }
+};
+
+// === Background Checkpoints ===
+// Snapshots the bank to a file every interval on its own thread, so
+// restarts replay at most one interval's worth of log.
+class CheckpointWriter {
+private:
+    Bank& bank;
+    string path;
+    chrono::seconds interval;
+    mutex mtx;
+    condition_variable wake;
+    bool stopping = false;
+    thread worker;
+
+public:
+    CheckpointWriter(Bank& b, const string& snapshotPath, chrono::seconds every)
+        : bank(b), path(snapshotPath), interval(every) {
+        worker = thread([this] {
+            unique_lock<mutex> lock(mtx);
+            while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+                lock.unlock();
+                if (!bank.checkpoint(path)) cout << "Error: Cannot write snapshot " << path << endl;
+                lock.lock();
+            }
+        });
+    }
+
+    ~CheckpointWriter() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+};
+
+// === Transaction Ingest ===
+// Producers (ATMs, feeds) hand requests to a BatchExecutor instead of
+// calling the Bank themselves. Pushing onto its queue is one atomic
+// exchange, so producers never wait on account locks. A single executor
+// thread takes whatever has queued up, up to a batch limit, and applies
+// it: runs of deposits and withdrawals are grouped by account (stable
+// sort, so each account still sees its requests in submission order) and
+// each group is applied under one lock acquisition. A transfer touches
+// two accounts, so it ends a run and is applied where it stands. With a
+// log attached, the whole batch is committed with one durability wait.
+// Completions run on the executor thread once the batch is durable.
+struct TransactionRequest {
+    enum Kind : uint8_t { Deposit, Withdraw, Transfer };
+
+    Kind kind;
+    int account;
+    int toAccount; // Transfer destination
+    double amount;
+};
+
+using TransactionCallback = function<void(bool accepted)>;
+
+// Vyukov's intrusive multi-producer single-consumer queue: producers swap
+// themselves in as the newest node and then link the previous newest to
+// it; the consumer follows next links from the oldest. A stub node keeps
+// the list non-empty, so producers and the consumer never touch the same
+// node except at the very end.
+class IngestQueue {
+public:
+    struct Node {
+        atomic<Node*> next{nullptr};
+        TransactionRequest request;
+        TransactionCallback done;
+    };
 
-    virtual ~Account() {}
+private:
+    alignas(64) atomic<Node*> newest;
+    alignas(64) Node* oldest; // consumer only
+    Node stub;
 
-    int getAccountNumber() const { return accountNumber; }
-    string getHolderName() const { return holderName; }
-    double getBalance() const { return balance; }
+public:
+    IngestQueue() : newest(&stub), oldest(&stub) {}
 
-    // Concrete method for deposit (same for all accounts)
-    void deposit(double amount) {
-        if (amount > 0) {
-            balance += amount;
-            cout << "Deposited: $" << fixed << setprecision(2) << amount << endl;
-            cout << "New Balance: $" << balance << endl;
-        } else {
-            cout << "Invalid deposit amount." << endl;
-        }
+    void push(Node* node) {
+        node->next.store(nullptr, memory_order_relaxed);
+        Node* previous = newest.exchange(node, memory_order_acq_rel);
+        previous->next.store(node, memory_order_release);
     }
 
-    // Pure virtual method for withdrawal (implementation varies)
-    virtual bool withdraw(double amount) = 0;
-
-    // Virtual display method
-    virtual void display() const {
-        cout << "Acc #: " << accountNumber << " | Holder: " << holderName 
-             << " | Balance: $" << fixed << setprecision(2) << balance;
+    // Oldest node, or nullptr if the queue is empty or its oldest node is
+    // still being linked by a producer (the caller just tries again)
+    Node* pop() {
+        Node* node = oldest;
+        Node* next = node->next.load(memory_order_acquire);
+        if (node == &stub) {
+            if (next == nullptr) return nullptr;
+            oldest = next;
+            node = next;
+            next = next->next.load(memory_order_acquire);
+        }
+        if (next != nullptr) {
+            oldest = next;
+            return node;
+        }
+        if (node != newest.load(memory_order_acquire)) return nullptr;
+        push(&stub); // node is the only one left: put the stub behind it
+        next = node->next.load(memory_order_acquire);
+        if (next != nullptr) {
+            oldest = next;
+            return node;
+        }
+        return nullptr;
     }
 };
 
-// === Derived Class: SavingsAccount ===
-class SavingsAccount : public Account {
+class BatchExecutor {
 private:
-    double interestRate; // Annual interest rate (e.g., 0.05 for 5%)
+    Bank& bank;
+    size_t maxBatch;
+    IngestQueue queue;
+    static const uint64_t STOP = 1ull << 63;
+    atomic<uint64_t> queued{0}; // pushed but not yet taken, plus STOP; the executor sleeps on it
+    thread worker;
 
-public:
-    SavingsAccount(int accNum, string name, double bal, double rate) 
-        : Account(accNum, name, bal), interestRate(rate) {}
+    atomic<uint64_t> batches{0};
+    atomic<uint64_t> applied{0};
 
-    bool withdraw(double amount) override {
-        if (amount > 0 && balance >= amount) {
-            balance -= amount;
-            cout << "Withdrawn: $" << fixed << setprecision(2) << amount << endl;
-            cout << "Remaining Balance: $" << balance << endl;
-            return true;
-        } else {
-            cout << "Transaction failed: Insufficient funds." << endl;
-            return false;
+    void applyBatch(const vector<IngestQueue::Node*>& batch) {
+        vector<char> accepted(batch.size(), 0);
+        vector<uint64_t> lsns(batch.size(), 0); // of each accepted request, when logged
+        vector<uint32_t> order; // positions of one run, grouped by account
+        vector<Bank::Posting> postings;
+        uint64_t lastLsn = 0;
+
+        auto applyRun = [&](size_t begin, size_t end) {
+            order.resize(end - begin);
+            iota(order.begin(), order.end(), (uint32_t)begin);
+            stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return batch[a]->request.account < batch[b]->request.account;
+            });
+            for (size_t i = 0; i < order.size();) {
+                int account = batch[order[i]]->request.account;
+                size_t j = i;
+                postings.clear();
+                for (; j < order.size() && batch[order[j]]->request.account == account; j++) {
+                    const TransactionRequest& r = batch[order[j]]->request;
+                    double amount = r.amount > 0 ? r.amount : 0; // so a bad amount fails as either kind
+                    postings.push_back({r.kind == TransactionRequest::Deposit ? amount : -amount});
+                }
+                lastLsn = max(lastLsn, bank.postAll(account, postings.data(), postings.size()));
+                for (size_t k = i; k < j; k++) {
+                    accepted[order[k]] = postings[k - i].ok;
+                    lsns[order[k]] = postings[k - i].lsn;
+                }
+                i = j;
+            }
+        };
+
+        size_t runStart = 0;
+        for (size_t i = 0; i < batch.size(); i++) {
+            const TransactionRequest& r = batch[i]->request;
+            if (r.kind != TransactionRequest::Transfer) continue;
+            applyRun(runStart, i);
+            accepted[i] = bank.transferUnawaited(r.account, r.toAccount, r.amount, lsns[i]);
+            lastLsn = max(lastLsn, lsns[i]);
+            runStart = i + 1;
+        }
+        applyRun(runStart, batch.size());
+
+        // If the log failed part-way, only the requests that reached disk
+        // before it did are reported as accepted
+        uint64_t durable = bank.awaitDurable(lastLsn) ? lastLsn : bank.durableLsn();
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (batch[i]->done) batch[i]->done(accepted[i] && lsns[i] <= durable);
+            delete batch[i];
         }
+        batches.fetch_add(1, memory_order_relaxed);
+        applied.fetch_add(batch.size(), memory_order_relaxed);
     }
 
-    void applyInterest() {
-        double interest = balance * interestRate;
-        balance += interest;
-        cout << "Interest Applied: $" << fixed << setprecision(2) << interest << endl;
-        cout << "New Balance: $" << balance << endl;
+    void run() {
+        vector<IngestQueue::Node*> batch;
+        while (true) {
+            uint64_t state = queued.load();
+            uint64_t waiting = state & ~STOP;
+            if (waiting == 0) {
+                if (state & STOP) return;
+                queued.wait(state);
+                continue;
+            }
+            batch.clear();
+            while (batch.size() < maxBatch && batch.size() < waiting) {
+                IngestQueue::Node* node = queue.pop();
+                if (node == nullptr) {
+                    if (!batch.empty()) break;
+                    this_thread::yield(); // a producer is between its two steps
+                    continue;
+                }
+                batch.push_back(node);
+            }
+            queued.fetch_sub(batch.size());
+            applyBatch(batch);
+        }
     }
 
-    void display() const override {
-        Account::display();
-        cout << " | Type: Savings | Rate: " << (interestRate * 100) << "%" << endl;
+public:
+    explicit BatchExecutor(Bank& b, size_t batchLimit = 1024) : bank(b), maxBatch(max<size_t>(batchLimit, 1)) {
+        worker = thread(&BatchExecutor::run, this);
+    }
+
+    BatchExecutor(const BatchExecutor&) = delete;
+    BatchExecutor& operator=(const BatchExecutor&) = delete;
+
+    // Applies everything already submitted, then stops
+    ~BatchExecutor() {
+        queued.fetch_or(STOP);
+        queued.notify_one();
+        worker.join();
+    }
+
+    // Queue a request; done(accepted) runs on the executor thread once it
+    // has been applied (and logged, with a log attached)
+    void submit(const TransactionRequest& request, TransactionCallback done) {
+        auto* node = new IngestQueue::Node;
+        node->request = request;
+        node->done = move(done);
+        queue.push(node);
+        if ((queued.fetch_add(1) & ~STOP) == 0) queued.notify_one();
     }
+
+    future<bool> submit(const TransactionRequest& request) {
+        auto result = make_shared<promise<bool>>();
+        future<bool> accepted = result->get_future();
+        submit(request, [result](bool ok) { result->set_value(ok); });
+        return accepted;
+    }
+
+    uint64_t batchCount() const { return batches.load(); }
+    uint64_t appliedCount() const { return applied.load(); }
 };
 
-// === Derived Class: CheckingAccount ===
-class CheckingAccount : public Account {
+// === Columnar Account Store ===
+// Batch jobs such as month-end interest touch one or two fields of every
+// account. Here each field is its own contiguous column, so a pass streams
+// only the data it uses and vectorizes. Checking accounts have a rate of
+// zero, so posting interest needs no branch on the account type.
+class AccountColumns {
 private:
-    double overdraftLimit; // Amount allowed to overdraw
+    vector<int32_t> numbers;
+    vector<AccountType> types;
+    vector<double> balances;
+    vector<double> rates;  // interest rate; 0 for checking accounts
+    vector<double> limits; // overdraft limit; 0 for savings accounts
+    vector<string> holders;
 
 public:
-    CheckingAccount(int accNum, string name, double bal, double limit) 
-        : Account(accNum, name, bal), overdraftLimit(limit) {}
+    void reserve(size_t n) {
+        numbers.reserve(n);
+        types.reserve(n);
+        balances.reserve(n);
+        rates.reserve(n);
+        limits.reserve(n);
+        holders.reserve(n);
+    }
 
-    bool withdraw(double amount) override {
-        if (amount > 0 && (balance + overdraftLimit) >= amount) {
-            balance -= amount;
-            cout << "Withdrawn: $" << fixed << setprecision(2) << amount << endl;
-            if (balance < 0) {
-                cout << "Notice: You are using overdraft." << endl;
+    void add(AccountType type, int accNum, const string& holder, double balance, double terms) {
+        numbers.push_back(accNum);
+        types.push_back(type);
+        balances.push_back(balance);
+        rates.push_back(type == AccountType::Savings ? terms : 0.0);
+        limits.push_back(type == AccountType::Checking ? terms : 0.0);
+        holders.push_back(holder);
+    }
+
+    // Columns holding the accounts of a snapshot, in the same order
+    static AccountColumns fromSnapshot(const SnapshotImage& image) {
+        AccountColumns columns;
+        columns.reserve(image.entries.size());
+        for (const SnapshotEntry& e : image.entries) {
+            columns.add((AccountType)e.accountType, e.accountNumber, image.names.substr(e.nameOffset, e.nameLength),
+                        e.balance, e.terms);
+        }
+        return columns;
+    }
+
+    size_t size() const { return numbers.size(); }
+    int accountNumber(size_t i) const { return numbers[i]; }
+    AccountType type(size_t i) const { return types[i]; }
+    double balance(size_t i) const { return balances[i]; }
+
+    // Post one period's interest to every savings account with the given
+    // kernel, split over threads in cache-line sized chunks. Balances come
+    // out bit-identical to SavingsAccount::postInterest on each account.
+    void applyInterestAll(const interest::Kernel& kernel, int threads) {
+        interest::postParallel(kernel, balances.data(), rates.data(), size(), threads);
+    }
+};
+
+// === Lookup Benchmark ===
+// Per-call latency of findAccount for random existing account numbers,
+// hash index against the old linear scan, at growing bank sizes. The scan
+// gets fewer samples at large sizes since each one walks millions of accounts.
+void runLookupBenchmark() {
+    cout << "=== Account Lookup Latency (ns) ===" << endl;
+    cout << left << setw(12) << "Accounts" << setw(8) << "Method" << setw(10) << "Samples"
+         << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "p99.9" << "max" << endl;
+
+    mt19937 rng(7);
+    for (int n : {10000, 1000000, 10000000}) {
+        Bank bank;
+        bank.reserve(n);
+        for (int i = 0; i < n; i++) {
+            bank.addAccount(AccountType::Savings, 1001 + i, "Holder", 100.0, 0.02);
+        }
+
+        auto measure = [&](const string& method, int samples, Account* (Bank::*lookup)(int)) {
+            uniform_int_distribution<int> pick(1001, 1000 + n);
+            vector<long long> ns(samples);
+            size_t misses = 0;
+            for (int s = 0; s < samples; s++) {
+                int accNum = pick(rng);
+                auto start = chrono::steady_clock::now();
+                Account* acc = (bank.*lookup)(accNum);
+                auto end = chrono::steady_clock::now();
+                if (acc == nullptr || acc->getAccountNumber() != accNum) misses++;
+                ns[s] = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
             }
-            cout << "New Balance: $" << balance << endl;
-            return true;
+            sort(ns.begin(), ns.end());
+            auto pct = [&](double p) { return ns[min((size_t)(p * samples), ns.size() - 1)]; };
+            cout << left << setw(12) << n << setw(8) << method << setw(10) << samples << setw(10) << pct(0.50)
+                 << setw(10) << pct(0.99) << setw(10) << pct(0.999) << ns.back()
+                 << (misses ? "  LOOKUP ERRORS" : "") << endl;
+        };
+
+        measure("hash", 1000000, &Bank::findAccount);
+        measure("scan", (int)min<long long>(100000, 2000000000LL / n), &Bank::scanForAccount);
+    }
+}
+
+// === Concurrency Stress Test ===
+// Threads hammer a few accounts with random transactions. Amounts are whole
+// dollars, so every sum is exact:
+//   1. transfers only, while another thread keeps taking consistent totals,
+//      each of which must equal the opening total (no half-done transfer
+//      is ever visible);
+//   2. a mix of transfers, deposits and withdrawals, after which the total
+//      must equal the opening total plus accepted deposits minus accepted
+//      withdrawals.
+// Then throughput is measured with each thread on its own accounts, which
+// should scale with cores since those threads share no lock.
+bool runStressTest(int threads) {
+    const int ACCOUNTS = 64; // few accounts: heavy contention and many opposite transfers
+    const int OPS_PER_THREAD = 200000;
+
+    Bank bank;
+    for (int i = 0; i < ACCOUNTS; i++) {
+        if (i % 2 == 0) {
+            bank.addAccount(AccountType::Savings, 1001 + i, "Stress", 1000, 0.01);
         } else {
-            cout << "Transaction failed: Exceeds overdraft limit." << endl;
+            bank.addAccount(AccountType::Checking, 1001 + i, "Stress", 1000, 500);
+        }
+    }
+    const double opening = bank.totalBalance();
+    cout << "=== Transaction Engine Stress Test (" << threads << " threads, " << ACCOUNTS << " accounts) ===" << endl;
+
+    auto runThreads = [&](const function<void(int)>& body) {
+        vector<thread> pool;
+        for (int t = 0; t < threads; t++) pool.emplace_back(body, t);
+        for (auto& th : pool) th.join();
+    };
+
+    // Phase 1: transfers only, audited while running
+    atomic<bool> running{true};
+    long long audits = 0, badAudits = 0;
+    thread auditor([&] {
+        while (running.load()) {
+            if (bank.totalBalance() != opening) badAudits++;
+            audits++;
+        }
+    });
+    runThreads([&](int t) {
+        mt19937 rng(t + 1);
+        uniform_int_distribution<int> pick(1001, 1000 + ACCOUNTS), amount(1, 200);
+        for (int op = 0; op < OPS_PER_THREAD; op++) bank.transfer(pick(rng), pick(rng), amount(rng));
+    });
+    running = false;
+    auditor.join();
+    bool phase1 = badAudits == 0 && bank.totalBalance() == opening;
+    cout << left << setw(36) << "Transfers only (" + to_string(audits) + " audits)" << (phase1 ? "PASS" : "FAIL") << endl;
+
+    // Phase 2: mixed transactions
+    atomic<long long> deposited{0}, withdrawn{0};
+    runThreads([&](int t) {
+        mt19937 rng(100 + t);
+        uniform_int_distribution<int> pick(1001, 1000 + ACCOUNTS), amount(1, 200), kind(0, 9);
+        long long dep = 0, wd = 0;
+        for (int op = 0; op < OPS_PER_THREAD; op++) {
+            int k = kind(rng);
+            int a = amount(rng);
+            if (k < 6) {
+                bank.transfer(pick(rng), pick(rng), a);
+            } else if (k < 8) {
+                if (bank.tryDeposit(pick(rng), a)) dep += a;
+            } else {
+                if (bank.tryWithdraw(pick(rng), a)) wd += a;
+            }
+        }
+        deposited += dep;
+        withdrawn += wd;
+    });
+    double expected = opening + (double)deposited - (double)withdrawn;
+    bool phase2 = bank.totalBalance() == expected;
+    cout << left << setw(36) << "Mixed transactions" << (phase2 ? "PASS" : "FAIL") << endl;
+
+    // Throughput on disjoint accounts
+    cout << left << setw(10) << "Threads" << setw(16) << "Mops/s" << "Speedup" << endl;
+    double base = 0;
+    for (int t = 1; t <= threads; t = (t * 2 > threads && t != threads) ? threads : t * 2) {
+        Bank own;
+        for (int i = 0; i < t * 2; i++) own.addAccount(AccountType::Checking, 1001 + i, "Bench", 1000000, 0);
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (int w = 0; w < t; w++) {
+            pool.emplace_back([&own, w] {
+                int a = 1001 + 2 * w, b = a + 1;
+                for (int op = 0; op < OPS_PER_THREAD; op++) {
+                    if (op % 2 == 0) own.transfer(a, b, 1); else own.transfer(b, a, 1);
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        double mops = (double)t * OPS_PER_THREAD / elapsed.count() / 1e6;
+        if (t == 1) base = mops;
+        cout << left << setw(10) << t << setw(16) << fixed << setprecision(2) << mops << mops / base << endl;
+    }
+    return phase1 && phase2;
+}
+
+// === Log Failure Test ===
+// Logs to /dev/full, so the first sync fails. That change must be
+// reported as not committed, and from then on every kind of change must
+// be refused without touching a balance or opening an account.
+bool runLogFailureTest() {
+    const int ACCOUNTS = 4;
+    Bank bank;
+    for (int i = 0; i < ACCOUNTS; i++) bank.addAccount(AccountType::Savings, 1001 + i, "Holder", 1000, 0.01);
+    WriteAheadLog wal;
+    if (!wal.open("/dev/full", 1, WriteAheadLog::Options{})) {
+        cout << "Error: Cannot open /dev/full" << endl;
+        return false;
+    }
+    bank.attachLog(&wal);
+
+    cout << "=== Log Failure Test ===" << endl;
+    bool first = !bank.tryDeposit(1001, 50) && bank.logFailed();
+    cout << left << setw(36) << "Failed write not committed" << (first ? "PASS" : "FAIL") << endl;
+
+    auto balances = [&] {
+        vector<double> all;
+        for (int i = 0; i < ACCOUNTS; i++) all.push_back(bank.findAccount(1001 + i)->getBalance());
+        return all;
+    };
+    const vector<double> before = balances();
+    const size_t accounts = bank.accountCount();
+    Bank::Posting postings[2] = {{25}, {-25}};
+    bool refused = !bank.tryDeposit(1002, 10) && !bank.tryWithdraw(1002, 10) &&
+                   !bank.transfer(1002, 1003, 10) && !bank.postInterestAll() &&
+                   bank.postAll(1004, postings, 2) == 0 && !postings[0].ok && !postings[1].ok &&
+                   !bank.addAccount(AccountType::Checking, 2001, "Late", 500, 100) &&
+                   !bank.findAccount(2001);
+    bool unchanged = balances() == before && bank.accountCount() == accounts;
+    cout << left << setw(36) << "Later changes refused" << (refused ? "PASS" : "FAIL") << endl;
+    cout << left << setw(36) << "Balances and accounts unchanged" << (unchanged ? "PASS" : "FAIL") << endl;
+    return first && refused && unchanged;
+}
+
+// === Group Commit Benchmark ===
+// Many threads each deposit and wait for their deposit to be durable, for
+// a range of batch sizes. Batch size 1 is one fdatasync per transaction;
+// larger batches let concurrent commits share a sync. After each run the
+// log is replayed into a fresh bank, with a torn record appended to its
+// end, and the recovered total must match the live one.
+bool runWalBenchmark(int threads, WriteAheadLog::Options opts) {
+    const int ACCOUNTS = 1000;
+    const chrono::milliseconds RUN_TIME{1000};
+    const string path = "bank-bench.wal";
+
+    cout << "=== Group Commit Benchmark (" << threads << " threads, flush interval "
+         << opts.flushInterval.count() << "us) ===" << endl;
+    cout << left << setw(8) << "Batch" << setw(14) << "Commits/s" << setw(10) << "Syncs"
+         << setw(16) << "Records/sync" << "Recovery" << endl;
+
+    bool allRecovered = true;
+    for (size_t batch : {1, 8, 64, 512}) {
+        ::unlink(path.c_str());
+        opts.batchSize = batch;
+        double liveTotal;
+        long long commits = 0;
+        size_t syncs, records;
+        {
+            WriteAheadLog wal;
+            if (!wal.open(path, 1, opts)) {
+                cout << "Error: Cannot create " << path << endl;
+                return false;
+            }
+            Bank bank;
+            bank.attachLog(&wal);
+            for (int i = 0; i < ACCOUNTS; i++) bank.addAccount(AccountType::Savings, 1001 + i, "Bench", 100, 0.01);
+
+            atomic<bool> running{true};
+            atomic<long long> done{0};
+            vector<thread> pool;
+            for (int t = 0; t < threads; t++) {
+                pool.emplace_back([&, t] {
+                    mt19937 rng(t + 1);
+                    uniform_int_distribution<int> pick(1001, 1000 + ACCOUNTS), amount(1, 100);
+                    long long mine = 0;
+                    while (running.load(memory_order_relaxed)) {
+                        if (bank.tryDeposit(pick(rng), amount(rng))) mine++;
+                    }
+                    done += mine;
+                });
+            }
+            size_t syncsBefore = wal.syncCount(), recordsBefore = wal.recordCount();
+            this_thread::sleep_for(RUN_TIME);
+            running = false;
+            for (auto& th : pool) th.join();
+            commits = done.load();
+            syncs = wal.syncCount() - syncsBefore;
+            records = wal.recordCount() - recordsBefore;
+            liveTotal = bank.totalBalance();
+        }
+
+        // Simulate a crash part-way through writing one more record
+        int fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+        if (fd >= 0) {
+            const char torn[] = {24, 0, 0, 0, 1, 2};
+            if (::write(fd, torn, sizeof(torn)) < 0) cout << "Error: Cannot append to " << path << endl;
+            ::close(fd);
+        }
+        bool recovered;
+        {
+            streambuf* saved = cout.rdbuf(nullptr); // keep recovery notices out of the table
+            Bank restored;
+            restored.recover(path);
+            recovered = restored.totalBalance() == liveTotal;
+            cout.rdbuf(saved);
+        }
+        allRecovered = allRecovered && recovered;
+
+        double seconds = chrono::duration<double>(RUN_TIME).count();
+        cout << left << setw(8) << batch << setw(14) << fixed << setprecision(0) << commits / seconds
+             << setw(10) << syncs << setw(16) << setprecision(1) << (syncs ? (double)records / syncs : 0.0)
+             << (recovered ? "PASS" : "FAIL") << endl;
+    }
+    ::unlink(path.c_str());
+    return allRecovered;
+}
+
+// === Interest Posting Benchmark ===
+// Posts interest to a bank of mixed accounts one account at a time through
+// the Account* list, then through Bank::postInterestAll (gather, kernel,
+// scatter) on an identical bank, then to the same accounts held in columns
+// with each kernel and thread count. Every result must match the
+// per-account one bit for bit.
+bool runInterestBenchmark(int accountCount) {
+    const int PERIODS = 12;
+    auto openAccounts = [&](Bank& bank) {
+        bank.reserve(accountCount);
+        mt19937 rng(42);
+        uniform_real_distribution<double> balance(0, 100000), rate(0.001, 0.05);
+        for (int i = 0; i < accountCount; i++) {
+            if (i % 3 == 2) bank.addAccount(AccountType::Checking, 1001 + i, "Holder", balance(rng), 500);
+            else bank.addAccount(AccountType::Savings, 1001 + i, "Holder", balance(rng), rate(rng));
+        }
+    };
+    Bank bank;
+    openAccounts(bank);
+    const AccountColumns opening = AccountColumns::fromSnapshot(bank.captureSnapshot());
+
+    cout << "=== Interest Posting (" << accountCount << " accounts, " << PERIODS << " periods) ===" << endl;
+    cout << left << setw(28) << "Method" << setw(12) << "ms/period" << setw(16) << "Maccounts/s" << "Result" << endl;
+    auto report = [&](const string& method, chrono::duration<double> elapsed, const string& result) {
+        double seconds = elapsed.count() / PERIODS;
+        cout << left << setw(28) << method << setw(12) << fixed << setprecision(2) << seconds * 1000
+             << setw(16) << setprecision(1) << accountCount / seconds / 1e6 << result << endl;
+    };
+
+    auto start = chrono::steady_clock::now();
+    for (int p = 0; p < PERIODS; p++) bank.postInterestEach();
+    report("per-account (Account*)", chrono::steady_clock::now() - start, "reference");
+    const AccountColumns expected = AccountColumns::fromSnapshot(bank.captureSnapshot());
+
+    auto matches = [&](const AccountColumns& columns) {
+        bool matched = columns.size() == expected.size();
+        for (size_t i = 0; matched && i < columns.size(); i++) {
+            double a = columns.balance(i), b = expected.balance(i);
+            matched = columns.accountNumber(i) == expected.accountNumber(i) && memcmp(&a, &b, sizeof(a)) == 0;
+        }
+        return matched;
+    };
+
+    Bank batched;
+    openAccounts(batched);
+    start = chrono::steady_clock::now();
+    for (int p = 0; p < PERIODS; p++) batched.postInterestAll();
+    chrono::duration<double> batchTime = chrono::steady_clock::now() - start;
+    bool allMatched = matches(AccountColumns::fromSnapshot(batched.captureSnapshot()));
+    report("Bank::postInterestAll", batchTime, allMatched ? "MATCH" : "MISMATCH");
+
+    int cores = (int)max(1u, thread::hardware_concurrency());
+    vector<int> threadCounts = {1};
+    if (cores > 1) threadCounts.push_back(cores);
+    for (const interest::Kernel& kernel : interest::supported()) {
+        for (int threads : threadCounts) {
+            AccountColumns columns = opening;
+            start = chrono::steady_clock::now();
+            for (int p = 0; p < PERIODS; p++) columns.applyInterestAll(kernel, threads);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+            bool matched = matches(columns);
+            allMatched = allMatched && matched;
+            report("columnar " + kernel.name + " x" + to_string(threads), elapsed, matched ? "MATCH" : "MISMATCH");
+        }
+    }
+    return allMatched;
+}
+
+// === Account Representation Benchmark ===
+// One random deposit/withdraw stream run against two copies of the same
+// accounts: each allocated by its own new and withdrawn through the virtual
+// debit(), as the bank used to, and all in an AccountPool withdrawn through
+// the type-tagged applyDebit(). Both must accept the same withdrawals and
+// end with the same balances.
+bool runAccountBenchmark() {
+    const int OPS = 4000000;
+    const int REPS = 5;
+    struct Op {
+        int32_t index;
+        int32_t amount; // positive: deposit, negative: withdrawal
+    };
+
+    cout << "=== Mixed Deposit/Withdraw Stream (" << OPS * REPS / 1000000 << "M operations) ===" << endl;
+    cout << left << setw(12) << "Accounts" << setw(26) << "Representation" << setw(10) << "ns/op" << "Result" << endl;
+
+    bool allMatched = true;
+    for (int n : {10000, 1000000}) {
+        vector<unique_ptr<Account>> heapAccounts;
+        vector<Account*> heap, pooled;
+        AccountPool pool;
+        pool.reserve(n);
+        for (int i = 0; i < n; i++) {
+            if (i % 2 == 0) heapAccounts.emplace_back(new SavingsAccount(1001 + i, "Holder", 500, 0.02));
+            else heapAccounts.emplace_back(new CheckingAccount(1001 + i, "Holder", 500, 200));
+            heap.push_back(heapAccounts.back().get());
+            pooled.push_back(pool.create(heap.back()->type(), 1001 + i, "Holder", 500, heap.back()->terms()));
+        }
+
+        mt19937 rng(n);
+        uniform_int_distribution<int> pick(0, n - 1), amount(1, 300), kind(0, 1);
+        vector<Op> ops(OPS);
+        for (Op& op : ops) op = {pick(rng), kind(rng) ? amount(rng) : -amount(rng)};
+
+        auto run = [&](const vector<Account*>& accounts, auto debit, long long& accepted) {
+            auto start = chrono::steady_clock::now();
+            for (int rep = 0; rep < REPS; rep++) {
+                for (const Op& op : ops) {
+                    Account* acc = accounts[op.index];
+                    if (op.amount > 0) acc->credit(op.amount);
+                    else accepted += debit(acc, -op.amount);
+                }
+            }
+            chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+            return elapsed.count() / ((double)OPS * REPS);
+        };
+
+        long long heapAccepted = 0, poolAccepted = 0;
+        double heapNs = run(heap, [](Account* a, double x) { return a->debit(x); }, heapAccepted);
+        double poolNs = run(pooled, [](Account* a, double x) { return a->applyDebit(x); }, poolAccepted);
+
+        bool matched = heapAccepted == poolAccepted;
+        for (int i = 0; matched && i < n; i++) matched = heap[i]->getBalance() == pooled[i]->getBalance();
+        allMatched = allMatched && matched;
+
+        cout << left << setw(12) << n << setw(26) << "heap + virtual debit" << setw(10) << fixed << setprecision(2)
+             << heapNs << "reference" << endl;
+        cout << left << setw(12) << n << setw(26) << "pool + tagged applyDebit" << setw(10) << poolNs
+             << (matched ? "MATCH" : "MISMATCH") << "  (" << setprecision(2) << heapNs / poolNs << "x)" << endl;
+    }
+    return allMatched;
+}
+
+// === Event Sink Benchmark ===
+// Threads run deposits and withdrawals through the reporting Account
+// methods with each way of reporting: the old synchronous stream output
+// (a line at a time with endl, under the stream's lock), the text and
+// binary sinks behind the event ring, and silent mode. Output goes to a
+// scratch file; times include waiting for the writer to finish.
+bool runEventBenchmark(int threads) {
+    const int OPS_PER_THREAD = 200000;
+    const string path = "bank-events.out";
+    const long long total = (long long)threads * OPS_PER_THREAD;
+
+    cout << "=== Transaction Reporting (" << threads << " threads, " << total << " transactions) ===" << endl;
+    cout << left << setw(30) << "Reporting" << setw(10) << "ns/op" << "Output" << endl;
+
+    auto timeRun = [&](const string& label, const function<void(Account&, int)>& transact, const function<void()>& finish) {
+        AccountPool pool;
+        vector<Account*> own;
+        for (int t = 0; t < threads; t++) own.push_back(pool.create(AccountType::Checking, 1001 + t, "Bench", 0, 1e12));
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (int op = 0; op < OPS_PER_THREAD; op++) transact(*own[t], op);
+            });
+        }
+        for (auto& th : workers) th.join();
+        finish();
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        struct stat st;
+        long long bytes = stat(path.c_str(), &st) == 0 ? (long long)st.st_size : 0;
+        cout << left << setw(30) << label << setw(10) << fixed << setprecision(1) << elapsed.count() / total
+             << bytes / 1024 << " KiB" << endl;
+        return bytes;
+    };
+
+    // The old reporting, reproduced: formatted straight to the stream with endl
+    {
+        ofstream out(path, ios::trunc);
+        mutex outLock;
+        timeRun("synchronous stream (old)", [&](Account& acc, int op) {
+            if (op % 2 == 0) {
+                acc.credit(1);
+                lock_guard<mutex> lock(outLock);
+                out << "Deposited: $" << fixed << setprecision(2) << 1.0 << endl;
+                out << "New Balance: $" << acc.getBalance() << endl;
+            } else {
+                acc.debit(1);
+                lock_guard<mutex> lock(outLock);
+                out << "Withdrawn: $" << fixed << setprecision(2) << 1.0 << endl;
+                out << "New Balance: $" << acc.getBalance() << endl;
+            }
+        }, [] {});
+    }
+
+    auto transact = [](Account& acc, int op) {
+        if (op % 2 == 0) acc.deposit(1); else acc.withdraw(1);
+    };
+    auto drain = [] { events().flush(); };
+
+    bool complete = true;
+    {
+        ofstream out(path, ios::trunc);
+        events().setSink(make_unique<TextEventSink>(out));
+        timeRun("text sink (async)", transact, drain);
+        events().setSink(nullptr);
+    }
+    {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        events().setSink(make_unique<BinaryEventSink>(fd));
+        long long bytes = timeRun("binary sink (async)", transact, drain);
+        events().setSink(nullptr);
+        ::close(fd);
+        complete = bytes == total * (long long)sizeof(TransactionEvent); // no record lost
+    }
+    {
+        ::unlink(path.c_str());
+        events().setSilent(true);
+        timeRun("silent", transact, drain);
+        events().setSilent(false);
+    }
+    events().setSink(make_unique<TextEventSink>(cout));
+    ::unlink(path.c_str());
+    if (!complete) cout << "Error: binary sink lost records." << endl;
+    return complete;
+}
+
+// === Ingest Benchmark ===
+// Producer threads issue a skewed mix of deposits, withdrawals and
+// transfers (most of them to a few hot accounts, like busy merchants)
+// either by calling the Bank directly or through a BatchExecutor, with
+// completion by callback or by future. Each run must conserve money: the
+// closing total equals the opening total plus accepted deposits minus
+// accepted withdrawals. Runs are repeated with a transaction log, where
+// direct callers each wait for their own commit and a batch waits once.
+bool runIngestBenchmark(int producers) {
+    const int ACCOUNTS = 10000;
+    const int HOT_ACCOUNTS = 64;
+
+    cout << "=== Transaction Ingest (" << producers << " producers) ===" << endl;
+    cout << left << setw(32) << "Mode" << setw(12) << "Requests" << setw(12) << "Kreq/s" << setw(12) << "Avg batch"
+         << "Result" << endl;
+
+    enum class Mode { Direct, Callbacks, Futures };
+    bool allPassed = true;
+    auto runMode = [&](const string& label, Mode mode, int perProducer, bool logged) {
+        const string path = "bank-ingest.wal";
+        ::unlink(path.c_str());
+        WriteAheadLog wal;
+        Bank bank;
+        if (logged && !wal.open(path, 1, WriteAheadLog::Options{})) {
+            cout << "Error: Cannot create " << path << endl;
+            allPassed = false;
+            return;
+        }
+        for (int i = 0; i < ACCOUNTS; i++) bank.addAccount(AccountType::Checking, 1001 + i, "Ingest", 10000, 1000);
+        if (logged) bank.attachLog(&wal);
+        const double opening = bank.totalBalance();
+
+        atomic<long long> deposited{0}, withdrawn{0}, completed{0};
+        auto settle = [&](bool ok, int signedAmount) {
+            if (ok && signedAmount > 0) deposited += signedAmount;
+            if (ok && signedAmount < 0) withdrawn -= signedAmount;
+            completed++;
+        };
+        unique_ptr<BatchExecutor> executor;
+        if (mode != Mode::Direct) executor = make_unique<BatchExecutor>(bank);
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (int p = 0; p < producers; p++) {
+            pool.emplace_back([&, p] {
+                mt19937 rng(p + 1);
+                uniform_int_distribution<int> any(1001, 1000 + ACCOUNTS), hot(1001, 1000 + HOT_ACCOUNTS);
+                uniform_int_distribution<int> percent(0, 99), amount(1, 200);
+                vector<pair<future<bool>, int>> window; // (accepted, signed amount)
+                for (int op = 0; op < perProducer; op++) {
+                    int account = percent(rng) < 80 ? hot(rng) : any(rng);
+                    int k = percent(rng);
+                    int a = amount(rng);
+                    TransactionRequest r{TransactionRequest::Transfer, account, any(rng), (double)a};
+                    int signedAmount = 0; // net money in (+) or out (-) of the bank
+                    if (k < 45) { r.kind = TransactionRequest::Deposit; signedAmount = a; }
+                    else if (k < 90) { r.kind = TransactionRequest::Withdraw; signedAmount = -a; }
+
+                    if (mode == Mode::Direct) {
+                        bool ok = r.kind == TransactionRequest::Deposit ? bank.tryDeposit(r.account, r.amount)
+                                : r.kind == TransactionRequest::Withdraw ? bank.tryWithdraw(r.account, r.amount)
+                                : bank.transfer(r.account, r.toAccount, r.amount);
+                        settle(ok, signedAmount);
+                    } else if (mode == Mode::Callbacks) {
+                        // Runs on the executor thread, after this producer may have finished
+                        executor->submit(r, [&settle, signedAmount](bool ok) { settle(ok, signedAmount); });
+                    } else {
+                        window.emplace_back(executor->submit(r), signedAmount);
+                        if (window.size() == 256 || op + 1 == perProducer) {
+                            for (auto& [accepted, amt] : window) settle(accepted.get(), amt);
+                            window.clear();
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        long long total = (long long)producers * perProducer;
+        while (completed.load() < total) this_thread::yield();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        double avgBatch = executor ? (double)executor->appliedCount() / max<uint64_t>(executor->batchCount(), 1) : 1;
+        executor.reset();
+        bool ok = bank.totalBalance() == opening + (double)deposited - (double)withdrawn;
+        allPassed = allPassed && ok;
+        cout << left << setw(32) << label << setw(12) << total << setw(12) << fixed << setprecision(1)
+             << total / elapsed.count() / 1000 << setw(12) << avgBatch << (ok ? "PASS" : "FAIL") << endl;
+        wal.close();
+        ::unlink(path.c_str());
+    };
+
+    runMode("direct calls", Mode::Direct, 200000, false);
+    runMode("executor + callbacks", Mode::Callbacks, 200000, false);
+    runMode("executor + futures", Mode::Futures, 200000, false);
+    runMode("direct calls, logged", Mode::Direct, 1000, true);
+    runMode("executor + callbacks, logged", Mode::Callbacks, 1000, true);
+    return allPassed;
+}
+
+// === Restart Benchmark ===
+// Builds a logged history from many threads (account openings, then
+// transfers and deposits), checkpoints it, and logs a further tail of
+// transactions. Then times recovery both ways: replaying the whole log,
+// and loading the snapshot plus the tail. Both must rebuild the live bank.
+bool runRestartBenchmark(int accountCount, int transactions) {
+    const int THREADS = 64; // enough concurrent commits to fill log batches
+    const string logPath = "bank-bench.wal";
+    const string snapshotPath = "bank-bench.snap";
+    ::unlink(logPath.c_str());
+    ::unlink(snapshotPath.c_str());
+
+    cout << "=== Restart Benchmark (" << accountCount << " accounts, " << transactions
+         << " transactions + " << transactions / 10 << " after the checkpoint) ===" << endl;
+
+    double liveTotal;
+    size_t liveCount;
+    {
+        WriteAheadLog::Options opts;
+        opts.batchSize = THREADS;
+        WriteAheadLog wal;
+        if (!wal.open(logPath, 1, opts)) {
+            cout << "Error: Cannot create " << logPath << endl;
+            return false;
+        }
+        Bank bank;
+        bank.reserve(accountCount);
+        bank.attachLog(&wal);
+
+        auto runThreads = [&](const function<void(int)>& body) {
+            vector<thread> pool;
+            for (int t = 0; t < THREADS; t++) pool.emplace_back(body, t);
+            for (auto& th : pool) th.join();
+        };
+        auto runTransactions = [&](int total, int seed) {
+            runThreads([&](int t) {
+                mt19937 rng(seed + t);
+                uniform_int_distribution<int> pick(1001, 1000 + accountCount), amount(1, 100), kind(0, 9);
+                for (int op = t; op < total; op += THREADS) {
+                    if (kind(rng) < 7) bank.transfer(pick(rng), pick(rng), amount(rng));
+                    else bank.tryDeposit(pick(rng), amount(rng));
+                }
+            });
+        };
+
+        runThreads([&](int t) {
+            for (int i = t; i < accountCount; i += THREADS) {
+                if (i % 2 == 0) bank.addAccount(AccountType::Savings, 1001 + i, "Holder " + to_string(i), 1000, 0.02);
+                else bank.addAccount(AccountType::Checking, 1001 + i, "Holder " + to_string(i), 1000, 500);
+            }
+        });
+        runTransactions(transactions, 1);
+
+        auto start = chrono::steady_clock::now();
+        SnapshotImage image = bank.captureSnapshot();
+        chrono::duration<double, milli> pause = chrono::steady_clock::now() - start;
+        if (!wal.waitDurable(image.lsn)) return false;
+        start = chrono::steady_clock::now();
+        bool written = snapshot::write(snapshotPath, image);
+        chrono::duration<double, milli> writing = chrono::steady_clock::now() - start;
+        if (!written) {
+            cout << "Error: Cannot write snapshot " << snapshotPath << endl;
             return false;
         }
+        cout << "Checkpoint at LSN " << image.lsn << ": transactions paused " << fixed << setprecision(1)
+             << pause.count() << " ms, snapshot written in " << writing.count() << " ms" << endl;
+
+        runTransactions(transactions / 10, 1000);
+        liveTotal = bank.totalBalance();
+        liveCount = bank.accountCount();
     }
 
-    void display() const override {
-        Account::display();
-        cout << " | Type: Checking | Overdraft Limit: $" << overdraftLimit << endl;
+    struct stat logStat, snapStat;
+    stat(logPath.c_str(), &logStat);
+    stat(snapshotPath.c_str(), &snapStat);
+    cout << "Log " << logStat.st_size / 1024 << " KiB, snapshot " << snapStat.st_size / 1024 << " KiB" << endl;
+    cout << left << setw(22) << "Restart from" << setw(14) << "Time (ms)" << "Result" << endl;
+
+    bool allPassed = true;
+    double fullMs = 0;
+    auto timeRecovery = [&](const string& label, const string& snapshot) {
+        streambuf* saved = cout.rdbuf(nullptr); // keep recovery notices out of the table
+        Bank restored;
+        auto start = chrono::steady_clock::now();
+        restored.recover(logPath, snapshot);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        cout.rdbuf(saved);
+        bool ok = restored.totalBalance() == liveTotal && restored.accountCount() == liveCount;
+        allPassed = allPassed && ok;
+        if (snapshot.empty()) fullMs = elapsed.count();
+        cout << left << setw(22) << label << setw(14) << fixed << setprecision(1) << elapsed.count()
+             << (ok ? "PASS" : "FAIL");
+        if (!snapshot.empty()) cout << "  (" << setprecision(1) << fullMs / elapsed.count() << "x faster)";
+        cout << endl;
+    };
+    timeRecovery("full log replay", "");
+    timeRecovery("snapshot + log tail", snapshotPath);
+
+    ::unlink(logPath.c_str());
+    ::unlink(snapshotPath.c_str());
+    return allPassed;
+}
+
+// === Load Generator ===
+// Replays a synthetic workload against a fresh Bank and reports throughput
+// and latency percentiles. Configurable: account count, thread count, run
+// time, deposit/withdraw/transfer mix, Zipfian skew of which accounts are
+// used (theta 0 is uniform; 0.99 sends most traffic to a few accounts, as
+// in YCSB), and whether changes go through a transaction log.
+struct LoadConfig {
+    int accounts = 100000;
+    int threads = (int)max(1u, thread::hardware_concurrency());
+    double seconds = 3;
+    int depositPercent = 40;
+    int withdrawPercent = 40; // the rest are transfers
+    double zipfTheta = 0.99;
+    bool logged = false;
+    WriteAheadLog::Options logOptions;
+};
+
+// Ranks 0..n-1 drawn with P(rank k) proportional to 1 / (k + 1)^theta, in
+// O(1) per draw (Gray et al., "Quickly Generating Billion-Record Synthetic
+// Databases"). Needs 0 <= theta < 1; the setup sums n terms once.
+class ZipfGenerator {
+private:
+    uint64_t n;
+    double theta, alpha, zetaN, eta, halfPowTheta;
+    uniform_real_distribution<double> unit{0.0, 1.0};
+
+    static double zeta(uint64_t n, double theta) {
+        double sum = 0;
+        for (uint64_t i = 1; i <= n; i++) sum += 1.0 / pow((double)i, theta);
+        return sum;
+    }
+
+public:
+    ZipfGenerator(uint64_t count, double skew) : n(max<uint64_t>(count, 1)), theta(clamp(skew, 0.0, 0.999)) {
+        zetaN = zeta(n, theta);
+        alpha = 1.0 / (1.0 - theta);
+        double zeta2 = zeta(min<uint64_t>(n, 2), theta);
+        eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / zetaN);
+        halfPowTheta = 1.0 + pow(0.5, theta);
+    }
+
+    template <class Rng>
+    uint64_t operator()(Rng& rng) {
+        double u = unit(rng);
+        double uz = u * zetaN;
+        if (uz < 1.0) return 0;
+        if (uz < halfPowTheta) return min<uint64_t>(1, n - 1);
+        return min<uint64_t>((uint64_t)((double)n * pow(eta * u - eta + 1.0, alpha)), n - 1);
     }
 };
 
-// === Bank Management Class ===
-class Bank {
+// Log-linear latency histogram in the style of HdrHistogram: exact below
+// 128 ns, and above that 64 buckets per power of two, so every recorded
+// value is within 1/64 (about 1.6%) of its bucket's lower bound. Fixed
+// size, so recording is an increment and histograms merge by addition.
+class LatencyHistogram {
 private:
-    vector<Account*> accounts;
+    static const int SUB_BITS = 7;
+    static const int HALF = 1 << (SUB_BITS - 1);
+    static const int BUCKETS = (64 - SUB_BITS + 1) * HALF + 2 * HALF;
+
+    array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t maxValue = 0;
+
+    static int bucketOf(uint64_t v) {
+        if (v < (uint64_t)2 * HALF) return (int)v;
+        int shift = (63 - __builtin_clzll(v)) - (SUB_BITS - 1);
+        return shift * HALF + (int)(v >> shift);
+    }
+
+    static uint64_t lowestIn(int bucket) {
+        if (bucket < 2 * HALF) return (uint64_t)bucket;
+        int shift = bucket / HALF - 1;
+        return (uint64_t)(bucket - shift * HALF) << shift;
+    }
 
 public:
-    ~Bank() {
-        // Clean up memory
-        for (Account* acc : accounts) {
-            delete acc;
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)]++;
+        total++;
+        maxValue = max(maxValue, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+        total += other.total;
+        maxValue = max(maxValue, other.maxValue);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t maximum() const { return maxValue; }
+
+    // Smallest recorded value (to bucket precision) at or above fraction p of all values
+    uint64_t percentile(double p) const {
+        if (total == 0) return 0;
+        uint64_t rank = (uint64_t)ceil(p * (double)total);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= max<uint64_t>(rank, 1)) return min(lowestIn(i), maxValue);
         }
+        return maxValue;
     }
+};
+
+bool runLoadGenerator(const LoadConfig& config) {
+    const string path = "bank-loadgen.wal";
+    enum { DEPOSIT, WITHDRAW, TRANSFER, KINDS };
+    const char* kindNames[KINDS] = {"deposit", "withdraw", "transfer"};
 
-    void openAccount(Account* acc) {
-        accounts.push_back(acc);
-        cout << "Account created successfully!" << endl;
+    WriteAheadLog wal;
+    Bank bank;
+    bank.reserve(config.accounts);
+    for (int i = 0; i < config.accounts; i++) {
+        if (i % 2 == 0) bank.addAccount(AccountType::Savings, 1001 + i, "Load", 10000, 0.02);
+        else bank.addAccount(AccountType::Checking, 1001 + i, "Load", 10000, 1000);
     }
+    if (config.logged) {
+        ::unlink(path.c_str());
+        if (!wal.open(path, 1, config.logOptions)) {
+            cout << "Error: Cannot create " << path << endl;
+            return false;
+        }
+        bank.attachLog(&wal);
+    }
+    const double opening = bank.totalBalance();
+    ZipfGenerator shared(config.accounts, config.zipfTheta); // copied per thread, so the sum runs once
 
-    Account* findAccount(int accNum) {
-        for (Account* acc : accounts) {
-            if (acc->getAccountNumber() == accNum) {
-                return acc;
+    cout << "=== Load Generator ===" << endl;
+    cout << config.accounts << " accounts, " << config.threads << " threads, " << config.seconds << " s, mix "
+         << config.depositPercent << "/" << config.withdrawPercent << "/"
+         << 100 - config.depositPercent - config.withdrawPercent << " deposit/withdraw/transfer, zipf theta "
+         << config.zipfTheta << (config.logged ? ", logged" : "") << endl;
+
+    struct Worker {
+        array<LatencyHistogram, KINDS> latency;
+        array<uint64_t, KINDS> accepted{};
+        long long deposited = 0, withdrawn = 0;
+    };
+    vector<Worker> workers(config.threads);
+    auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                                                       chrono::duration<double>(config.seconds));
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < config.threads; t++) {
+        pool.emplace_back([&, t] {
+            Worker& w = workers[t];
+            ZipfGenerator pick = shared;
+            mt19937_64 rng(t + 1);
+            uniform_int_distribution<int> percent(0, 99), amount(1, 200);
+            while (true) {
+                int from = 1001 + (int)pick(rng);
+                int to = 1001 + (int)pick(rng);
+                int a = amount(rng);
+                int p = percent(rng);
+                int kind = p < config.depositPercent ? DEPOSIT
+                         : p < config.depositPercent + config.withdrawPercent ? WITHDRAW : TRANSFER;
+
+                auto before = chrono::steady_clock::now();
+                if (before >= deadline) break;
+                bool ok = kind == DEPOSIT ? bank.tryDeposit(from, a)
+                        : kind == WITHDRAW ? bank.tryWithdraw(from, a)
+                        : bank.transfer(from, to, a);
+                auto after = chrono::steady_clock::now();
+
+                w.latency[kind].record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(after - before).count());
+                if (ok) {
+                    w.accepted[kind]++;
+                    if (kind == DEPOSIT) w.deposited += a;
+                    if (kind == WITHDRAW) w.withdrawn += a;
+                }
             }
-        }
-        return nullptr;
+        });
     }
+    for (auto& th : pool) th.join();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
 
-    void deposit(int accNum, double amount) {
-        Account* acc = findAccount(accNum);
-        if (acc) {
-            acc->deposit(amount);
-        } else {
-            cout << "Account not found." << endl;
+    array<LatencyHistogram, KINDS> latency;
+    LatencyHistogram overall;
+    array<uint64_t, KINDS> accepted{};
+    long long deposited = 0, withdrawn = 0;
+    for (const Worker& w : workers) {
+        for (int k = 0; k < KINDS; k++) {
+            latency[k].merge(w.latency[k]);
+            overall.merge(w.latency[k]);
+            accepted[k] += w.accepted[k];
         }
+        deposited += w.deposited;
+        withdrawn += w.withdrawn;
     }
 
-    void withdraw(int accNum, double amount) {
-        Account* acc = findAccount(accNum);
-        if (acc) {
-            acc->withdraw(amount);
-        } else {
-            cout << "Account not found." << endl;
+    cout << "Throughput: " << fixed << setprecision(0) << overall.count() / elapsed.count() << " ops/s ("
+         << overall.count() << " ops)" << endl;
+    cout << left << setw(10) << "Op" << setw(12) << "Count" << setw(10) << "Accepted" << setw(10) << "p50"
+         << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "p99.99" << "max (ns)" << endl;
+    auto row = [](const string& name, const LatencyHistogram& h, uint64_t ok) {
+        cout << left << setw(10) << name << setw(12) << h.count() << setw(10) << fixed << setprecision(1)
+             << (h.count() ? 100.0 * (double)ok / (double)h.count() : 0.0) << setw(10) << h.percentile(0.50)
+             << setw(10) << h.percentile(0.90) << setw(10) << h.percentile(0.99) << setw(10) << h.percentile(0.999)
+             << setw(10) << h.percentile(0.9999) << h.maximum() << endl;
+    };
+    for (int k = 0; k < KINDS; k++) row(kindNames[k], latency[k], accepted[k]);
+    row("all", overall, accepted[DEPOSIT] + accepted[WITHDRAW] + accepted[TRANSFER]);
+
+    bool conserved = bank.totalBalance() == opening + (double)deposited - (double)withdrawn;
+    cout << "Money conservation: " << (conserved ? "PASS" : "FAIL") << endl;
+    if (config.logged) {
+        wal.close();
+        ::unlink(path.c_str());
+    }
+    return conserved;
+}
+
+// === Main Function ===
+int main(int argc, char* argv[]) {
+    // Command-line modes:
+    //   --bench-lookup   findAccount latency percentiles at 10K, 1M and 10M accounts
+    //   --stress [N]     N-thread transaction stress test (money conservation) and scaling
+    //   --test-log-failure  a failed log write makes the bank refuse every later change
+    //   --bench-wal [N]  N-thread group commit throughput by batch size, with recovery check
+    //   --bench-restart [ACCOUNTS] [TRANSACTIONS]
+    //                    restart time from a snapshot plus log tail against a full log replay
+    //   --bench-interest [N]  per-account vs columnar SIMD interest posting over N accounts
+    //   --bench-accounts heap/virtual vs pooled/tag-dispatched accounts on a mixed stream
+    //   --bench-events [N]  N-thread transaction reporting: old synchronous output vs event sinks
+    //   --bench-ingest [N]  N producers: direct Bank calls vs the batching executor
+    //   --loadgen        synthetic workload with latency percentiles, configured by
+    //                    --accounts N, --threads N, --seconds S, --mix D,W (deposit and
+    //                    withdraw percent; the rest are transfers), --zipf THETA (0 to 0.999)
+    //                    and --logged (log to a scratch file; honors --flush-us and --batch)
+    // Options:
+    //   --wal PATH       recover from the transaction log at PATH, then log every change to it
+    //   --flush-us N     longest a commit waits for its group to fill (default 2000)
+    //   --batch N        most transactions per log sync (default 256)
+    //   --checkpoint-s N seconds between snapshots of a logged bank to PATH.snap (default 60)
+    string walPath;
+    WriteAheadLog::Options walOptions;
+    int checkpointSeconds = 60;
+    LoadConfig load;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--logged") load.logged = true;
+    }
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--accounts") load.accounts = max(atoi(argv[i + 1]), 2);
+        if (arg == "--threads") load.threads = max(atoi(argv[i + 1]), 1);
+        if (arg == "--seconds") load.seconds = max(atof(argv[i + 1]), 0.1);
+        if (arg == "--zipf") load.zipfTheta = atof(argv[i + 1]);
+        if (arg == "--mix" && sscanf(argv[i + 1], "%d,%d", &load.depositPercent, &load.withdrawPercent) == 2) {
+            load.depositPercent = clamp(load.depositPercent, 0, 100);
+            load.withdrawPercent = clamp(load.withdrawPercent, 0, 100 - load.depositPercent);
         }
+        if (arg == "--wal") walPath = argv[i + 1];
+        if (arg == "--flush-us") walOptions.flushInterval = chrono::microseconds(atoi(argv[i + 1]));
+        if (arg == "--batch") walOptions.batchSize = (size_t)max(atoi(argv[i + 1]), 1);
+        if (arg == "--checkpoint-s") checkpointSeconds = max(atoi(argv[i + 1]), 1);
     }
 
-    void displayAll() {
-        if (accounts.empty()) {
-            cout << "No accounts to display." << endl;
-            return;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--bench-lookup") {
+            runLookupBenchmark();
+            return 0;
         }
-        cout << "\n--- All Bank Accounts ---" << endl;
-        for (const auto& acc : accounts) {
-            acc->display();
+        if (arg == "--stress") {
+            int threads = i + 1 < argc ? atoi(argv[i + 1]) : (int)thread::hardware_concurrency();
+            return runStressTest(max(threads, 2)) ? 0 : 1;
+        }
+        if (arg == "--test-log-failure") {
+            return runLogFailureTest() ? 0 : 1;
+        }
+        if (arg == "--bench-wal") {
+            int threads = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : 64;
+            return runWalBenchmark(max(threads, 1), walOptions) ? 0 : 1;
+        }
+        if (arg == "--bench-interest") {
+            int accounts = i + 1 < argc ? atoi(argv[i + 1]) : 2000000;
+            return runInterestBenchmark(max(accounts, 1)) ? 0 : 1;
+        }
+        if (arg == "--bench-accounts") {
+            return runAccountBenchmark() ? 0 : 1;
+        }
+        if (arg == "--bench-events") {
+            int threads = i + 1 < argc ? atoi(argv[i + 1]) : 4;
+            return runEventBenchmark(max(threads, 1)) ? 0 : 1;
+        }
+        if (arg == "--bench-ingest") {
+            int producers = i + 1 < argc ? atoi(argv[i + 1]) : 8;
+            return runIngestBenchmark(max(producers, 1)) ? 0 : 1;
+        }
+        if (arg == "--loadgen") {
+            load.logOptions = walOptions;
+            return runLoadGenerator(load) ? 0 : 1;
+        }
+        if (arg == "--bench-restart") {
+            int accounts = i + 1 < argc ? atoi(argv[i + 1]) : 100000;
+            int transactions = i + 2 < argc ? atoi(argv[i + 2]) : 1000000;
+            return runRestartBenchmark(max(accounts, 2), max(transactions, 0)) ? 0 : 1;
         }
     }
-};
 
-// === Main Function ===
-int main() {
     Bank myBank;
     int choice;
     int nextAccNum = 1001; // Auto-increment account numbers
 
+    WriteAheadLog wal;
+    unique_ptr<CheckpointWriter> checkpoints;
+    string snapshotPath = walPath + ".snap";
+    if (!walPath.empty()) {
+        uint64_t lastLsn = myBank.recover(walPath, snapshotPath);
+        if (!wal.open(walPath, lastLsn + 1, walOptions)) {
+            cout << "Error: Cannot open transaction log " << walPath << endl;
+            return 1;
+        }
+        myBank.attachLog(&wal);
+        checkpoints = make_unique<CheckpointWriter>(myBank, snapshotPath, chrono::seconds(checkpointSeconds));
+        nextAccNum = max(nextAccNum, myBank.highestAccountNumber() + 1);
+    }
+
     cout << "=== Banking System Simulator ===" << endl;
 
     while (true) {
@@ -179,8 +2847,9 @@ int main() {
         cout << "2. Open Checking Account\n";
         cout << "3. Deposit\n";
         cout << "4. Withdraw\n";
-        cout << "5. Display All Accounts\n";
-        cout << "6. Exit\n";
+        cout << "5. Transfer\n";
+        cout << "6. Display All Accounts\n";
+        cout << "7. Exit\n";
         cout << "Enter Choice: ";
         
         if (!(cin >> choice)) {
@@ -190,7 +2859,7 @@ int main() {
             continue;
         }
 
-        if (choice == 6) break;
+        if (choice == 7) break;
 
         switch (choice) {
             case 1: {
@@ -201,7 +2870,7 @@ int main() {
                 getline(cin, name);
                 cout << "Initial Deposit: "; cin >> initialDep;
                 cout << "Interest Rate (e.g., 0.03 for 3%): "; cin >> rate;
-                myBank.openAccount(new SavingsAccount(nextAccNum++, name, initialDep, rate));
+                myBank.openAccount(AccountType::Savings, nextAccNum++, name, initialDep, rate);
                 break;
             }
             case 2: {
@@ -212,7 +2881,7 @@ int main() {
                 getline(cin, name);
                 cout << "Initial Deposit: "; cin >> initialDep;
                 cout << "Overdraft Limit: "; cin >> limit;
-                myBank.openAccount(new CheckingAccount(nextAccNum++, name, initialDep, limit));
+                myBank.openAccount(AccountType::Checking, nextAccNum++, name, initialDep, limit);
                 break;
             }
             case 3: {
@@ -231,7 +2900,16 @@ int main() {
                 myBank.withdraw(accNum, amount);
                 break;
             }
-            case 5:
+            case 5: {
+                int fromNum, toNum;
+                double amount;
+                cout << "From Account Number: "; cin >> fromNum;
+                cout << "To Account Number: "; cin >> toNum;
+                cout << "Enter Transfer Amount: "; cin >> amount;
+                myBank.transferFunds(fromNum, toNum, amount);
+                break;
+            }
+            case 6:
                 myBank.displayAll();
                 break;
             default:
@@ -239,6 +2917,10 @@ int main() {
         }
     }
 
+    if (checkpoints) {
+        checkpoints.reset();
+        myBank.checkpoint(snapshotPath); // next start needs no log replay
+    }
     cout << "Exiting Banking System..." << endl;
     return 0;
 }
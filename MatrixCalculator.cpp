@@ -2,30 +2,849 @@
 #include <vector>
 #include <iomanip>
 #include <limits>
+#include <algorithm> // For min, fill_n, copy_n
+#include <chrono>    // For benchmark timing
+#include <cstdlib>   // For aligned_alloc, free, rand
+#include <memory>    // For unique_ptr
+#include <string>
+#include <thread>             // For the worker pool
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <random>             // For the SIMD self-test inputs
+#include <optional>
+#include <type_traits>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>            // For index_sequence
+#include <cstring>            // For memcmp, memcpy
+#include <cmath>              // For fabs in the floating-point self-test
+#include <cstdio>             // For rename
+#include <fcntl.h>            // POSIX open / mmap for the binary file mode
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
-// Class to represent a mathematical Matrix
-class Matrix {
+// === Element Types ===
+// Matrices can hold int32, int64, float or double elements. Each element
+// type has an accumulator type that dot products are summed in: int32 sums
+// widen to int64 by default, so a long row of large products doesn't
+// overflow part-way; the other types accumulate in themselves. A float
+// matrix can opt into double accumulation with BasicMatrix<float, double>.
+template <class T>
+concept MatrixElement = is_same_v<T, int32_t> || is_same_v<T, int64_t> || is_same_v<T, float> || is_same_v<T, double>;
+
+template <class T>
+struct DefaultAccumulator {
+    using type = T;
+};
+
+template <>
+struct DefaultAccumulator<int32_t> {
+    using type = int64_t;
+};
+
+template <class T>
+const char* typeName() {
+    if constexpr (is_same_v<T, int32_t>) return "int32";
+    else if constexpr (is_same_v<T, int64_t>) return "int64";
+    else if constexpr (is_same_v<T, float>) return "float";
+    else return "double";
+}
+
+// Numeric codes for the element types, as stored in binary matrix file
+// headers and chosen on the command line with --dtype
+const uint32_t DTYPE_INT32 = 1;
+const uint32_t DTYPE_INT64 = 2;
+const uint32_t DTYPE_FLOAT32 = 3;
+const uint32_t DTYPE_FLOAT64 = 4;
+
+template <class T>
+constexpr uint32_t dtypeOf() {
+    if constexpr (is_same_v<T, int32_t>) return DTYPE_INT32;
+    else if constexpr (is_same_v<T, int64_t>) return DTYPE_INT64;
+    else if constexpr (is_same_v<T, float>) return DTYPE_FLOAT32;
+    else return DTYPE_FLOAT64;
+}
+
+// Code for a type name as printed by typeName(), or 0 if there is none
+uint32_t dtypeFromName(const string& name) {
+    if (name == typeName<int32_t>()) return DTYPE_INT32;
+    if (name == typeName<int64_t>()) return DTYPE_INT64;
+    if (name == typeName<float>()) return DTYPE_FLOAT32;
+    if (name == typeName<double>()) return DTYPE_FLOAT64;
+    return 0;
+}
+
+// Call fn(T{}) for the element type with the given code; false if unknown
+template <class F>
+bool withElementType(uint32_t dtype, F&& fn) {
+    switch (dtype) {
+        case DTYPE_INT32: fn(int32_t{}); return true;
+        case DTYPE_INT64: fn(int64_t{}); return true;
+        case DTYPE_FLOAT32: fn(float{}); return true;
+        case DTYPE_FLOAT64: fn(double{}); return true;
+        default: return false;
+    }
+}
+
+// === Aligned Storage ===
+// Matrix elements live in one 64-byte aligned block so every row starts
+// on a cache-line boundary and the kernels below can use aligned loads.
+// A non-owning deleter lets a Matrix view memory it didn't allocate,
+// such as a memory-mapped file.
+template <class T>
+struct AlignedFree {
+    bool owned = true;
+    void operator()(T* p) const {
+        if (owned) free(p);
+    }
+};
+
+template <class T>
+using AlignedBuffer = unique_ptr<T[], AlignedFree<T>>;
+
+template <class T>
+AlignedBuffer<T> allocAligned(size_t count) {
+    if (count == 0) return AlignedBuffer<T>(nullptr);
+    size_t bytes = (count * sizeof(T) + 63) / 64 * 64; // aligned_alloc needs a multiple of the alignment
+    T* p = static_cast<T*>(aligned_alloc(64, bytes));
+    if (p == nullptr) throw bad_alloc();
+    return AlignedBuffer<T>(p);
+}
+
+// === Thread Pool ===
+// A fixed set of workers that execute parallelFor() jobs. The calling thread
+// joins in as one extra worker, and tasks are handed out through an atomic
+// counter so uneven tiles balance themselves. The pool runs one job at a
+// time: a parallelFor() that finds it busy (another thread's job, or a
+// nested call) runs its tasks on the calling thread instead.
+class ThreadPool {
+private:
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable wake;
+    condition_variable finished;
+    const function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    atomic<int> nextIndex{0};
+    atomic<bool> running{false}; // a job owns the pool
+    int busyWorkers = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+
+    void drain() {
+        int i;
+        while ((i = nextIndex.fetch_add(1)) < jobCount) {
+            (*job)(i);
+        }
+    }
+
+    void workerLoop() {
+        unsigned seen = 0;
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+
+            lock.unlock();
+            drain();
+            lock.lock();
+
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+
+public:
+    explicit ThreadPool(int threads) {
+        for (int i = 1; i < threads; i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    int size() const { return (int)workers.size() + 1; }
+
+    // Run fn(0) .. fn(count - 1) across the pool and wait for all of them
+    void parallelFor(int count, const function<void(int)>& fn) {
+        if (workers.empty() || count <= 1 || running.exchange(true, memory_order_acquire)) {
+            for (int i = 0; i < count; i++) fn(i);
+            return;
+        }
+        {
+            lock_guard<mutex> lock(mtx);
+            job = &fn;
+            jobCount = count;
+            nextIndex = 0;
+            busyWorkers = (int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        drain();
+
+        {
+            unique_lock<mutex> lock(mtx);
+            finished.wait(lock, [&] { return busyWorkers == 0; });
+        }
+        running.store(false, memory_order_release);
+    }
+};
+
+// === Parallel Execution Settings ===
+// Operations smaller than these thresholds stay on the calling thread,
+// where the cost of waking the pool would outweigh the work itself.
+namespace parallel {
+    const size_t MIN_ELEMENTS = 1 << 16; // element-wise ops (~256x256)
+    const double MIN_FLOPS = 4.0e6;      // multiply (~128x128x128)
+
+    int threadCount = max(1, (int)thread::hardware_concurrency());
+    unique_ptr<ThreadPool> pool;
+    mutex poolLock; // guards creating and replacing the pool
+
+    // Only while no matrix operation is running: the old pool is destroyed
+    void setThreadCount(int n) {
+        lock_guard<mutex> lock(poolLock);
+        threadCount = max(1, n);
+        pool.reset(); // rebuilt lazily with the new size
+    }
+
+    // Safe from any thread; the first caller builds the pool
+    ThreadPool& getPool() {
+        lock_guard<mutex> lock(poolLock);
+        if (!pool) pool = make_unique<ThreadPool>(threadCount);
+        return *pool;
+    }
+
+    // Split [0, n) into contiguous chunks and run fn(begin, end) on each
+    void forRange(size_t n, const function<void(size_t, size_t)>& fn) {
+        if (threadCount == 1 || n < MIN_ELEMENTS) {
+            fn(0, n);
+            return;
+        }
+        int chunks = threadCount * 4;
+        size_t step = (n + chunks - 1) / chunks;
+        getPool().parallelFor(chunks, [&](int t) {
+            size_t begin = min(n, t * step);
+            size_t end = min(n, begin + step);
+            if (begin < end) fn(begin, end);
+        });
+    }
+}
+
+// === SIMD Kernels ===
+// Vector versions of the inner loops for SSE4.2, AVX2 and AVX-512, plus a
+// portable scalar fallback. Each loop is written once with GCC vector
+// extensions and instantiated per element type inside wrappers compiled for
+// each instruction set with a target attribute, so the binary still runs on
+// older CPUs. The best set the CPU supports is chosen via CPUID the first
+// time an element type is used. Integer paths wrap like the hardware and are
+// bit-identical to scalar; floating-point paths differ only in rounding
+// (the vector builds contract multiply-add into FMA).
+namespace simd {
+    // Integer lanes are unsigned, so overflow wraps instead of being undefined
+    template <class T>
+    struct LaneOf {
+        using type = T;
+    };
+
+    template <class T> requires is_integral_v<T>
+    struct LaneOf<T> {
+        using type = make_unsigned_t<T>;
+    };
+
+    template <class T>
+    using Lane = typename LaneOf<T>::type;
+
+    // Type the micro-kernel sums in. A wider integer sum narrowed back to T
+    // has exactly the bits of wrapping T arithmetic, so integer kernels keep
+    // T-wide lanes (twice as many per vector) without changing any result;
+    // floating-point kernels really accumulate in Acc.
+    template <class T, class Acc>
+    using KernelAcc = conditional_t<is_integral_v<T> && is_integral_v<Acc>, T, Acc>;
+
+    template <class T>
+    using ElementwiseFn = void (*)(const T* a, const T* b, T* out, size_t n);
+
+    template <class T>
+    using MicroKernelFn = void (*)(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr);
+
+    template <class T>
+    struct KernelSet {
+        string name;
+        int mr; // rows of C per micro-kernel call
+        int nr; // cols of C per micro-kernel call
+        ElementwiseFn<T> add;
+        ElementwiseFn<T> sub;
+        MicroKernelFn<T> mulAcc; // mr x nr tile of C += packed A panel * packed B panel
+    };
+
+    template <class T>
+    inline T wrapAdd(T x, T y) { return (T)((Lane<T>)x + (Lane<T>)y); }
+
+    template <class T>
+    inline T wrapSub(T x, T y) { return (T)((Lane<T>)x - (Lane<T>)y); }
+
+    template <class T, bool Subtract>
+    void addSubScalar(const T* a, const T* b, T* out, size_t n) {
+        for (size_t i = 0; i < n; i++) out[i] = Subtract ? wrapSub(a[i], b[i]) : wrapAdd(a[i], b[i]);
+    }
+
+    const int SCALAR_MR = 4;
+    const int SCALAR_NR = 4;
+
+    template <class T, class A>
+    void mulAccScalar(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr) {
+        using U = Lane<A>;
+        U acc[SCALAR_MR * SCALAR_NR] = {};
+        for (int k = 0; k < kc; k++) {
+            for (int i = 0; i < SCALAR_MR; i++) {
+                U av = (U)(Lane<T>)a[k * SCALAR_MR + i];
+                for (int j = 0; j < SCALAR_NR; j++) {
+                    acc[i * SCALAR_NR + j] += av * (U)(Lane<T>)b[k * SCALAR_NR + j];
+                }
+            }
+        }
+        for (int i = 0; i < mr; i++) {
+            for (int j = 0; j < nr; j++) {
+                T& out = c[(size_t)i * ldc + j];
+                out = (T)((U)(Lane<T>)out + acc[i * SCALAR_NR + j]);
+            }
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Load W elements of T into a vector V, converting each lane (float to
+    // double for a widened accumulator; a no-op otherwise)
+    template <class V, int W, class T>
+    inline __attribute__((always_inline)) void loadLanes(V& v, const T* p) {
+        typedef Lane<T> N __attribute__((vector_size(W * sizeof(T))));
+        N n;
+        memcpy(&n, p, sizeof(N));
+        v = __builtin_convertvector(n, V);
+    }
+
+    template <class V, int W, class T>
+    inline __attribute__((always_inline)) void storeLanes(T* p, const V& v) {
+        typedef Lane<T> N __attribute__((vector_size(W * sizeof(T))));
+        N n = __builtin_convertvector(v, N);
+        memcpy(p, &n, sizeof(N));
+    }
+
+    // out = a (+/-) b in Bytes-wide vectors, then a scalar tail
+    template <class T, int Bytes, bool Subtract>
+    inline __attribute__((always_inline)) void addSubBody(const T* a, const T* b, T* out, size_t n) {
+        typedef Lane<T> V __attribute__((vector_size(Bytes)));
+        const size_t W = Bytes / sizeof(T);
+        size_t i = 0;
+        for (; i + W <= n; i += W) {
+            V x, y;
+            memcpy(&x, a + i, Bytes);
+            memcpy(&y, b + i, Bytes);
+            if constexpr (Subtract) x -= y; else x += y;
+            memcpy(out + i, &x, Bytes);
+        }
+        for (; i < n; i++) out[i] = Subtract ? wrapSub(a[i], b[i]) : wrapAdd(a[i], b[i]);
+    }
+
+    // MR x NR register tile accumulated in Bytes-wide vectors of A lanes.
+    // NR is two vectors wide, so the k loop holds 2 * MR accumulators plus
+    // two B vectors in registers and never touches C.
+    template <class T, class A, int Bytes, int MR, int NR>
+    inline __attribute__((always_inline)) void mulAccBody(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr) {
+        using U = Lane<A>;
+        typedef U V __attribute__((vector_size(Bytes)));
+        constexpr int W = Bytes / sizeof(U);
+        constexpr int NV = NR / W;
+
+        V acc[MR][NV] = {};
+        for (int k = 0; k < kc; k++) {
+            V bv[NV];
+#pragma GCC unroll 4
+            for (int v = 0; v < NV; v++) loadLanes<V, W>(bv[v], b + (size_t)k * NR + v * W);
+#pragma GCC unroll 16
+            for (int i = 0; i < MR; i++) {
+                U av = (U)(Lane<T>)a[k * MR + i];
+#pragma GCC unroll 4
+                for (int v = 0; v < NV; v++) acc[i][v] += av * bv[v];
+            }
+        }
+
+        if (mr == MR && nr == NR) {
+            for (int i = 0; i < MR; i++) {
+                T* row = c + (size_t)i * ldc;
+                for (int v = 0; v < NV; v++) {
+                    V cv;
+                    loadLanes<V, W>(cv, row + v * W);
+                    storeLanes<V, W>(row + v * W, cv + acc[i][v]);
+                }
+            }
+            return;
+        }
+        U tile[MR * NR];
+        for (int i = 0; i < MR; i++) {
+            for (int v = 0; v < NV; v++) memcpy(tile + i * NR + v * W, &acc[i][v], Bytes);
+        }
+        for (int i = 0; i < mr; i++) {
+            for (int j = 0; j < nr; j++) {
+                T& out = c[(size_t)i * ldc + j];
+                out = (T)((U)(Lane<T>)out + tile[i * NR + j]);
+            }
+        }
+    }
+
+    // Tile width: two vectors of accumulator lanes
+    template <class A>
+    constexpr int tileCols(int bytes) { return 2 * bytes / (int)sizeof(A); }
+
+    const int SSE42_MR = 4;  // 8 accumulators of 16 registers
+    const int AVX2_MR = 6;   // 12 accumulators of 16 registers
+    const int AVX512_MR = 8; // 16 accumulators of 32 registers
+
+    template <class T, bool Subtract>
+    __attribute__((target("sse4.2")))
+    void addSubSse42(const T* a, const T* b, T* out, size_t n) { addSubBody<T, 16, Subtract>(a, b, out, n); }
+
+    template <class T, class A>
+    __attribute__((target("sse4.2")))
+    void mulAccSse42(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr) {
+        mulAccBody<T, A, 16, SSE42_MR, tileCols<A>(16)>(kc, a, b, c, ldc, mr, nr);
+    }
+
+    template <class T, bool Subtract>
+    __attribute__((target("avx2")))
+    void addSubAvx2(const T* a, const T* b, T* out, size_t n) { addSubBody<T, 32, Subtract>(a, b, out, n); }
+
+    template <class T, class A>
+    __attribute__((target("avx2,fma")))
+    void mulAccAvx2(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr) {
+        mulAccBody<T, A, 32, AVX2_MR, tileCols<A>(32)>(kc, a, b, c, ldc, mr, nr);
+    }
+
+    template <class T, bool Subtract>
+    __attribute__((target("avx512f")))
+    void addSubAvx512(const T* a, const T* b, T* out, size_t n) { addSubBody<T, 64, Subtract>(a, b, out, n); }
+
+    // avx512dq provides the 64-bit integer multiply
+    template <class T, class A>
+    __attribute__((target("avx512f,avx512dq")))
+    void mulAccAvx512(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr) {
+        mulAccBody<T, A, 64, AVX512_MR, tileCols<A>(64)>(kc, a, b, c, ldc, mr, nr);
+    }
+#endif
+
+    // Every kernel set this CPU can run for T summed in Acc, fastest last
+    template <class T, class Acc>
+    vector<KernelSet<T>> supported() {
+        using A = KernelAcc<T, Acc>;
+        vector<KernelSet<T>> sets = {
+            {"scalar", SCALAR_MR, SCALAR_NR, addSubScalar<T, false>, addSubScalar<T, true>, mulAccScalar<T, A>}
+        };
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) {
+            sets.push_back({"sse4.2", SSE42_MR, tileCols<A>(16),
+                            addSubSse42<T, false>, addSubSse42<T, true>, mulAccSse42<T, A>});
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            sets.push_back({"avx2", AVX2_MR, tileCols<A>(32),
+                            addSubAvx2<T, false>, addSubAvx2<T, true>, mulAccAvx2<T, A>});
+        }
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+            sets.push_back({"avx512", AVX512_MR, tileCols<A>(64),
+                            addSubAvx512<T, false>, addSubAvx512<T, true>, mulAccAvx512<T, A>});
+        }
+#endif
+        return sets;
+    }
+
+    // Set forced with --isa; empty means the fastest one supported
+    string forcedIsa;
+
+    // Kernels for T summed in Acc, chosen on first use
+    template <class T, class Acc>
+    const KernelSet<T>& active() {
+        static const KernelSet<T> chosen = [] {
+            vector<KernelSet<T>> sets = supported<T, Acc>();
+            for (const auto& set : sets) {
+                if (set.name == forcedIsa) return set;
+            }
+            return sets.back();
+        }();
+        return chosen;
+    }
+
+    // Force a kernel set by name; must be called before any matrix work
+    bool select(const string& name) {
+        for (const auto& set : supported<int32_t, int32_t>()) {
+            if (set.name == name) {
+                forcedIsa = name;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// === Blocked GEMM Kernel ===
+// Computes C (m x n) += A (m x k) * B (k x n) on row-major buffers with the
+// given leading dimensions. The loops are tiled so a KC x NC panel of B and
+// an MC x KC block of A stay resident in cache; both are packed into
+// contiguous micro-panels, and the mr x nr register-blocked SIMD micro-kernel
+// accumulates each small tile of C without touching memory in the k loop.
+// The tile shape comes from the kernel set, as it depends on the vector
+// width and the element type.
+namespace gemm {
+    const int MC = 120;  // rows of A per packed block (~L2); a multiple of every tile height
+    const int KC = 256;  // depth of each packed panel (~L1 for one B micro-panel)
+    const int NC = 2048; // cols of B per packed panel (~L3)
+
+    // Pack an mc x kc block of A into mr-row micro-panels, k-major, zero padded.
+    // Negating while packing lets the same kernel compute C -= A * B.
+    template <class T>
+    void packA(int mc, int kc, const T* a, int lda, T* dst, int mr, bool negate) {
+        for (int p = 0; p < mc; p += mr) {
+            for (int k = 0; k < kc; k++) {
+                for (int i = 0; i < mr; i++) {
+                    T v = (p + i < mc) ? a[(size_t)(p + i) * lda + k] : T(0);
+                    *dst++ = negate ? simd::wrapSub(T(0), v) : v;
+                }
+            }
+        }
+    }
+
+    // Pack a kc x nc panel of B into nr-col micro-panels, k-major, zero padded
+    template <class T>
+    void packB(int kc, int nc, const T* b, int ldb, T* dst, int nr) {
+        for (int q = 0; q < nc; q += nr) {
+            int cols = min(nr, nc - q);
+            for (int k = 0; k < kc; k++) {
+                const T* row = b + (size_t)k * ldb + q;
+                int j = 0;
+                for (; j < cols; j++) *dst++ = row[j];
+                for (; j < nr; j++) *dst++ = T(0);
+            }
+        }
+    }
+
+    template <class T>
+    void multiplyWith(const simd::KernelSet<T>& kernels, int m, int n, int k, const T* a, int lda,
+                      const T* b, int ldb, T* c, int ldc, bool negate = false) {
+        if (m <= 0 || n <= 0 || k <= 0) return;
+        const int MR = kernels.mr;
+        const int NR = kernels.nr;
+        // Pack buffers sized to the actual problem, so small products stay cheap
+        size_t kMax = min(KC, k);
+        AlignedBuffer<T> packedA = allocAligned<T>((size_t)(min(MC, m) + MR - 1) / MR * MR * kMax);
+        AlignedBuffer<T> packedB = allocAligned<T>((size_t)(min(NC, n) + NR - 1) / NR * NR * kMax);
+        simd::MicroKernelFn<T> microKernel = kernels.mulAcc;
+
+        for (int jc = 0; jc < n; jc += NC) {
+            int nc = min(NC, n - jc);
+            for (int pc = 0; pc < k; pc += KC) {
+                int kc = min(KC, k - pc);
+                packB(kc, nc, b + (size_t)pc * ldb + jc, ldb, packedB.get(), NR);
+
+                for (int ic = 0; ic < m; ic += MC) {
+                    int mc = min(MC, m - ic);
+                    packA(mc, kc, a + (size_t)ic * lda + pc, lda, packedA.get(), MR, negate);
+
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            microKernel(kc,
+                                        packedA.get() + (size_t)ir * kc,
+                                        packedB.get() + (size_t)jr * kc,
+                                        c + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                        min(MR, mc - ir), min(NR, nc - jr));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    template <class T, class Acc>
+    void multiply(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc,
+                  bool negate = false) {
+        multiplyWith(simd::active<T, Acc>(), m, n, k, a, lda, b, ldb, c, ldc, negate);
+    }
+
+    // Split C into tiles of whole MC rows x TILE_N cols and multiply each
+    // tile on the pool; every tile packs its own A block and B panel.
+    template <class T, class Acc>
+    void parallelMultiply(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc,
+                          bool negate = false) {
+        const int TILE_N = 512;
+        double flops = 2.0 * m * n * k;
+        if (parallel::threadCount == 1 || flops < parallel::MIN_FLOPS) {
+            multiply<T, Acc>(m, n, k, a, lda, b, ldb, c, ldc, negate);
+            return;
+        }
+        int rowTiles = (m + MC - 1) / MC;
+        int colTiles = (n + TILE_N - 1) / TILE_N;
+        parallel::getPool().parallelFor(rowTiles * colTiles, [&](int t) {
+            int i0 = (t / colTiles) * MC;
+            int j0 = (t % colTiles) * TILE_N;
+            multiply<T, Acc>(min(MC, m - i0), min(TILE_N, n - j0), k,
+                             a + (size_t)i0 * lda, lda, b + j0, ldb,
+                             c + (size_t)i0 * ldc + j0, ldc, negate);
+        });
+    }
+
+    // === Strassen-Winograd ===
+    // 7 half-size products and 15 additions per level instead of 8 products.
+    // Quadrant products recurse until the size drops to strassenCrossover,
+    // where the blocked kernel takes over. Integer arithmetic wraps, so the
+    // result is exactly the same as the classic product; floating-point
+    // results differ by rounding (with somewhat larger error bounds), so it
+    // is off unless asked for with --strassen.
+    int strassenCrossover = 0; // 0 disables Strassen; tune with --bench-strassen
+
+    // out = x (+/-) y on h x h strided blocks; out may alias x or y
+    template <class T, class Acc>
+    void addBlocks(int h, const T* x, int ldx, const T* y, int ldy, T* out, int ldo, bool subtract) {
+        simd::ElementwiseFn<T> kernel = subtract ? simd::active<T, Acc>().sub : simd::active<T, Acc>().add;
+        for (int i = 0; i < h; i++) {
+            kernel(x + (size_t)i * ldx, y + (size_t)i * ldy, out + (size_t)i * ldo, h);
+        }
+    }
+
+    // C = A * B for n x n blocks where n = m * 2^d with m <= crossover.
+    // Uses the memory-efficient schedule of Boyer, Dumas, Pernet and Zhou:
+    // two h x h temporaries (X, Y) per level, everything else lives in C.
+    template <class T, class Acc>
+    void strassenRecursive(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, int crossover) {
+        if (n <= crossover || n % 2 != 0) {
+            for (int i = 0; i < n; i++) fill_n(c + (size_t)i * ldc, n, T(0));
+            parallelMultiply<T, Acc>(n, n, n, a, lda, b, ldb, c, ldc);
+            return;
+        }
+        int h = n / 2;
+        const T* a11 = a;
+        const T* a12 = a + h;
+        const T* a21 = a + (size_t)h * lda;
+        const T* a22 = a21 + h;
+        const T* b11 = b;
+        const T* b12 = b + h;
+        const T* b21 = b + (size_t)h * ldb;
+        const T* b22 = b21 + h;
+        T* c11 = c;
+        T* c12 = c + h;
+        T* c21 = c + (size_t)h * ldc;
+        T* c22 = c21 + h;
+
+        AlignedBuffer<T> xBuf = allocAligned<T>((size_t)h * h);
+        AlignedBuffer<T> yBuf = allocAligned<T>((size_t)h * h);
+        T* x = xBuf.get();
+        T* y = yBuf.get();
+        auto add = addBlocks<T, Acc>;
+        auto recurse = strassenRecursive<T, Acc>;
+
+        add(h, a11, lda, a21, lda, x, h, true);              // S3 = A11 - A21
+        add(h, b22, ldb, b12, ldb, y, h, true);              // T3 = B22 - B12
+        recurse(h, x, h, y, h, c21, ldc, crossover);         // P7 = S3 * T3
+        add(h, a21, lda, a22, lda, x, h, false);             // S1 = A21 + A22
+        add(h, b12, ldb, b11, ldb, y, h, true);              // T1 = B12 - B11
+        recurse(h, x, h, y, h, c22, ldc, crossover);         // P5 = S1 * T1
+        add(h, x, h, a11, lda, x, h, true);                  // S2 = S1 - A11
+        add(h, b22, ldb, y, h, y, h, true);                  // T2 = B22 - T1
+        recurse(h, x, h, y, h, c11, ldc, crossover);         // P6 = S2 * T2
+        add(h, a12, lda, x, h, x, h, true);                  // S4 = A12 - S2
+        add(h, y, h, b21, ldb, y, h, true);                  // T4 = T2 - B21
+        recurse(h, x, h, b22, ldb, c12, ldc, crossover);     // P3 = S4 * B22
+        recurse(h, a11, lda, b11, ldb, x, h, crossover);     // P1 = A11 * B11
+        add(h, x, h, c11, ldc, c11, ldc, false);             // U2 = P1 + P6
+        add(h, c11, ldc, c21, ldc, c21, ldc, false);         // U3 = U2 + P7
+        add(h, c11, ldc, c22, ldc, c11, ldc, false);         // U4 = U2 + P5
+        add(h, c21, ldc, c22, ldc, c22, ldc, false);         // U7 = U3 + P5  (C22)
+        add(h, c11, ldc, c12, ldc, c12, ldc, false);         // U5 = U4 + P3  (C12)
+        recurse(h, a22, lda, y, h, c11, ldc, crossover);     // P4 = A22 * T4
+        add(h, c21, ldc, c11, ldc, c21, ldc, true);          // U6 = U3 - P4  (C21)
+        recurse(h, a12, lda, b21, ldb, c11, ldc, crossover); // P2 = A12 * B21
+        add(h, x, h, c11, ldc, c11, ldc, false);             // U1 = P1 + P2  (C11)
+    }
+
+    // C = A * B for square n x n row-major matrices. n is padded with zeros
+    // up to m * 2^d (m <= crossover) so every level splits evenly.
+    template <class T, class Acc>
+    void strassenMultiply(int n, const T* a, const T* b, T* c, int crossover) {
+        int m = n, levels = 0;
+        while (m > crossover) {
+            m = (m + 1) / 2;
+            levels++;
+        }
+        int padded = m << levels;
+        if (padded == n) {
+            strassenRecursive<T, Acc>(n, a, n, b, n, c, n, crossover);
+            return;
+        }
+
+        AlignedBuffer<T> pa = allocAligned<T>((size_t)padded * padded);
+        AlignedBuffer<T> pb = allocAligned<T>((size_t)padded * padded);
+        AlignedBuffer<T> pc = allocAligned<T>((size_t)padded * padded);
+        fill_n(pa.get(), (size_t)padded * padded, T(0));
+        fill_n(pb.get(), (size_t)padded * padded, T(0));
+        for (int i = 0; i < n; i++) {
+            copy_n(a + (size_t)i * n, n, pa.get() + (size_t)i * padded);
+            copy_n(b + (size_t)i * n, n, pb.get() + (size_t)i * padded);
+        }
+        strassenRecursive<T, Acc>(padded, pa.get(), padded, pb.get(), padded, pc.get(), padded, crossover);
+        for (int i = 0; i < n; i++) {
+            copy_n(pc.get() + (size_t)i * padded, n, c + (size_t)i * n);
+        }
+    }
+}
+
+// Tag base class for lazy Matrix expression nodes (see Expression Templates)
+struct MatrixExpr {};
+
+template <class T, class Acc = typename DefaultAccumulator<T>::type>
+class BasicMatrix;
+
+template <class E>
+struct IsMatrix : false_type {};
+
+template <class T, class Acc>
+struct IsMatrix<BasicMatrix<T, Acc>> : true_type {};
+
+// A matrix or a lazy expression; every operand exposes the matrix type it
+// evaluates to as matrix_type, and only operands of one type can be mixed
+template <class E>
+concept MatrixOperand = IsMatrix<E>::value || is_base_of_v<MatrixExpr, E>;
+
+template <class E, class M>
+concept OperandOf = MatrixOperand<remove_cvref_t<E>> && is_same_v<typename remove_cvref_t<E>::matrix_type, M>;
+
+template <class E, class M>
+concept ExprOf = is_base_of_v<MatrixExpr, remove_cvref_t<E>> && OperandOf<E, M>;
+
+// Class to represent a mathematical Matrix of T elements whose products
+// are summed in Acc
+template <class T, class Acc>
+class BasicMatrix {
+    static_assert(MatrixElement<T> && MatrixElement<Acc>, "elements must be int32, int64, float or double");
+    static_assert(is_integral_v<T> == is_integral_v<Acc> && sizeof(Acc) >= sizeof(T),
+                  "the accumulator must be of the same kind and at least as wide as the element");
+
 private:
     int rows;
     int cols;
-    vector<vector<int>> data;
+    AlignedBuffer<T> data; // rows * cols elements, row-major, one contiguous block
+
+    static inline atomic<size_t> allocations{0}; // storage blocks allocated so far
 
 public:
+    using value_type = T;
+    using accumulator_type = Acc;
+    using matrix_type = BasicMatrix;
+
     // Constructor
-    Matrix(int r, int c) : rows(r), cols(c) {
-        data.resize(rows, vector<int>(cols, 0));
+    BasicMatrix(int r, int c) : rows(max(r, 0)), cols(max(c, 0)) {
+        data = allocAligned<T>((size_t)rows * cols);
+        if (data) allocations++;
+        fill_n(data.get(), (size_t)rows * cols, T(0));
+    }
+
+    BasicMatrix(const BasicMatrix& other) : BasicMatrix(other.rows, other.cols) {
+        copy_n(other.data.get(), (size_t)rows * cols, data.get());
+    }
+
+    BasicMatrix& operator=(const BasicMatrix& other) {
+        if (this != &other) {
+            BasicMatrix copy(other);
+            *this = move(copy);
+        }
+        return *this;
+    }
+
+    BasicMatrix(BasicMatrix&&) noexcept = default;
+    BasicMatrix& operator=(BasicMatrix&&) noexcept = default;
+
+    // Element-wise conversion from another element type, e.g. widening an
+    // int32 matrix to int64 before a product whose sums don't fit in 32 bits
+    template <class U, class A> requires (!is_same_v<BasicMatrix<U, A>, BasicMatrix>)
+    explicit BasicMatrix(const BasicMatrix<U, A>& other) : BasicMatrix(other.getRows(), other.getCols()) {
+        const U* src = other.rawData();
+        for (size_t i = 0; i < (size_t)rows * cols; i++) data[i] = (T)src[i];
+    }
+
+    // Non-owning r x c view over external storage (e.g. a mapped file).
+    // The storage must outlive the view; copies of a view own their data.
+    static BasicMatrix view(int r, int c, T* external) {
+        BasicMatrix m(0, 0);
+        m.rows = r;
+        m.cols = c;
+        m.data = AlignedBuffer<T>(external, AlignedFree<T>{false});
+        return m;
+    }
+
+    // Build from / assign a lazy expression such as A + B - C or A * B + C.
+    // The whole expression is evaluated directly into this matrix's storage;
+    // when the expression is a temporary that owns a Matrix temporary of the
+    // right shape (e.g. Matrix(A + B) + C), that buffer is reused instead.
+    template <class E> requires ExprOf<E, BasicMatrix<T, Acc>>
+    BasicMatrix(E&& e) : BasicMatrix(0, 0) {
+        *this = forward<E>(e);
+    }
+
+    template <class E> requires ExprOf<E, BasicMatrix<T, Acc>>
+    BasicMatrix& operator=(E&& e);
+
+    // Compound assignment, evaluated in place: A += B and A -= B never
+    // allocate. A *= B needs one new buffer, since GEMM can't overwrite its input.
+    // On a dimension mismatch the error is reported and A is left unchanged.
+    template <class E> requires OperandOf<E, BasicMatrix<T, Acc>>
+    BasicMatrix& operator+=(E&& e);
+
+    template <class E> requires OperandOf<E, BasicMatrix<T, Acc>>
+    BasicMatrix& operator-=(E&& e);
+
+    template <class E> requires OperandOf<E, BasicMatrix<T, Acc>>
+    BasicMatrix& operator*=(E&& e);
+
+    // Number of storage blocks every matrix of this type has allocated (instrumentation)
+    static size_t allocationCount() { return allocations; }
+
+    bool ownsData() const { return data && data.get_deleter().owned; }
+
+    // Take over donor's buffer; donor keeps reading the same memory through
+    // a non-owning view until it is destroyed
+    void adoptBuffer(BasicMatrix& donor) {
+        T* p = donor.data.release();
+        rows = donor.rows;
+        cols = donor.cols;
+        data = AlignedBuffer<T>(p);
+        donor.data = AlignedBuffer<T>(p, AlignedFree<T>{false});
     }
 
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+
+    T* rawData() { return data.get(); }
+    const T* rawData() const { return data.get(); }
+
+    T& at(int i, int j) { return data[(size_t)i * cols + j]; }
+    T at(int i, int j) const { return data[(size_t)i * cols + j]; }
+
     // Function to fill matrix with user input
     void input() {
         cout << "Enter elements for a " << rows << "x" << cols << " matrix:" << endl;
         for (int i = 0; i < rows; i++) {
             for (int j = 0; j < cols; j++) {
                 cout << "Element [" << i << "][" << j << "]: ";
-                while (!(cin >> data[i][j])) {
-                    cout << "Invalid input. Enter an integer: ";
+                while (!(cin >> at(i, j))) {
+                    cout << "Invalid input. Enter " << (is_integral_v<T> ? "an integer" : "a number") << ": ";
                     cin.clear();
                     cin.ignore(numeric_limits<streamsize>::max(), '\n');
                 }
@@ -33,74 +852,1452 @@ public:
         }
     }
 
+    // Fill with small pseudo-random values (used by the benchmark)
+    void randomize() {
+        for (size_t i = 0; i < (size_t)rows * cols; i++) {
+            data[i] = (T)(rand() % 10);
+        }
+    }
+
     // Function to display the matrix
     void display() const {
         for (int i = 0; i < rows; i++) {
             cout << "| ";
             for (int j = 0; j < cols; j++) {
-                cout << setw(4) << data[i][j] << " ";
+                cout << setw(4) << at(i, j) << " ";
             }
             cout << "|" << endl;
         }
     }
 
-    // Overloading the + operator for Matrix Addition
-    Matrix operator+(const Matrix& other) {
-        if (rows != other.rows || cols != other.cols) {
-            cout << "Error: Matrix dimensions must match for addition." << endl;
-            return Matrix(0, 0); // Return empty matrix on error
-        }
+    // Check if matrix is valid (not empty)
+    bool isValid() const {
+        return rows > 0 && cols > 0;
+    }
+};
 
-        Matrix result(rows, cols);
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                result.data[i][j] = this->data[i][j] + other.data[i][j];
+// The original integer matrix, with products summed in int64
+using Matrix = BasicMatrix<int>;
+
+// === Expression Templates ===
+// A + B, A - B and A * B don't compute anything on their own; they return
+// small nodes that record their operands. The tree is evaluated once it is
+// assigned to a Matrix:
+//   1. all element-wise terms (A, B, C in A + B - C) are combined in one
+//      fused pass over L1-sized chunks, written straight into the
+//      destination with the SIMD add/sub kernels;
+//   2. each product term is then accumulated into the destination by the
+//      blocked GEMM, negated when it is being subtracted.
+// So R = A + B - C and R = A * B + C allocate nothing besides R itself.
+// Only the operands of a product that are themselves expressions, as in
+// (A + B) * C, are materialized first, because GEMM packs from real storage.
+// Named matrices are held by reference; Matrix temporaries are moved into
+// the expression (TempMatrix) so their buffer can become the result.
+
+// Leaf for a Matrix temporary operand. The expression owns it, so it lives
+// as long as the expression does, and its buffer can be handed on to the
+// destination instead of allocating a fresh one.
+template <class M>
+class TempMatrix : public MatrixExpr {
+private:
+    mutable M m; // mutable so an rvalue expression can donate the buffer
+
+public:
+    using matrix_type = M;
+    using value_type = typename M::value_type;
+
+    TempMatrix(M&& t) : m(move(t)) {}
+
+    const M& matrix() const { return m; }
+    bool ok() const { return true; }
+    int getRows() const { return m.getRows(); }
+    int getCols() const { return m.getCols(); }
+
+    void applyChunk(value_type* out, size_t begin, size_t n, bool negate, bool& written) const;
+    void applyProducts(M&, bool) const {}
+    bool refersTo(const M* target) const;
+    bool productRefersTo(const M*) const { return false; }
+    M* donor() const { return m.ownsData() ? &m : nullptr; }
+};
+
+namespace expr {
+    const size_t CHUNK = 1024; // elements per fused step (4-8 KB per operand)
+
+    // Named leaves are held by reference, temporaries and nested nodes by value
+    template <class E>
+    using Stored = conditional_t<IsMatrix<E>::value, const E&, E>;
+
+    // Node type recorded for an operand: an rvalue matrix becomes a TempMatrix
+    template <class E>
+    using OperandType = conditional_t<IsMatrix<remove_cvref_t<E>>::value && !is_lvalue_reference_v<E>,
+                                      TempMatrix<remove_cvref_t<E>>, remove_cvref_t<E>>;
+
+    // --- Leaf (plain matrix) versions of the node interface ---
+
+    template <class T, class Acc>
+    bool ok(const BasicMatrix<T, Acc>&) { return true; }
+
+    // out (+/-)= m[begin .. begin + n); the first term written initializes out
+    template <class T, class Acc>
+    void applyChunk(const BasicMatrix<T, Acc>& m, T* out, size_t begin, size_t n, bool negate, bool& written) {
+        const T* src = m.rawData() + begin;
+        if (!written) {
+            if (negate) {
+                for (size_t i = 0; i < n; i++) out[i] = simd::wrapSub(T(0), src[i]);
+            } else {
+                copy_n(src, n, out);
             }
+            written = true;
+        } else {
+            const auto& kernels = simd::active<T, Acc>();
+            (negate ? kernels.sub : kernels.add)(out, src, out, n);
         }
-        return result;
     }
 
-    // Overloading the - operator for Matrix Subtraction
-    Matrix operator-(const Matrix& other) {
-        if (rows != other.rows || cols != other.cols) {
-            cout << "Error: Matrix dimensions must match for subtraction." << endl;
-            return Matrix(0, 0);
-        }
+    template <class T, class Acc>
+    void applyProducts(const BasicMatrix<T, Acc>&, BasicMatrix<T, Acc>&, bool) {}
 
-        Matrix result(rows, cols);
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                result.data[i][j] = this->data[i][j] - other.data[i][j];
-            }
-        }
-        return result;
+    // Compare storage rather than objects, so views and donated buffers count
+    template <class T, class Acc>
+    bool refersTo(const BasicMatrix<T, Acc>& m, const BasicMatrix<T, Acc>* target) {
+        return m.rawData() != nullptr && m.rawData() == target->rawData();
     }
 
-    // Overloading the * operator for Matrix Multiplication
-    Matrix operator*(const Matrix& other) {
-        if (cols != other.rows) {
-            cout << "Error: Cols of first matrix must equal rows of second for multiplication." << endl;
-            return Matrix(0, 0);
+    template <class T, class Acc>
+    bool productRefersTo(const BasicMatrix<T, Acc>&, const BasicMatrix<T, Acc>*) { return false; }
+
+    template <class T, class Acc>
+    BasicMatrix<T, Acc>* donor(const BasicMatrix<T, Acc>&) { return nullptr; }
+
+    // --- Nodes forward to their members ---
+
+    template <class E> requires is_base_of_v<MatrixExpr, E>
+    bool ok(const E& e) { return e.ok(); }
+
+    template <class E> requires is_base_of_v<MatrixExpr, E>
+    void applyChunk(const E& e, typename E::value_type* out, size_t begin, size_t n, bool negate, bool& written) {
+        e.applyChunk(out, begin, n, negate, written);
+    }
+
+    template <class E> requires is_base_of_v<MatrixExpr, E>
+    void applyProducts(const E& e, typename E::matrix_type& dst, bool negate) { e.applyProducts(dst, negate); }
+
+    template <class E> requires is_base_of_v<MatrixExpr, E>
+    bool refersTo(const E& e, const typename E::matrix_type* target) { return e.refersTo(target); }
+
+    template <class E> requires is_base_of_v<MatrixExpr, E>
+    bool productRefersTo(const E& e, const typename E::matrix_type* target) { return e.productRefersTo(target); }
+
+    // First matrix temporary among the element-wise terms whose buffer can be reused
+    template <class E> requires is_base_of_v<MatrixExpr, E>
+    typename E::matrix_type* donor(const E& e) { return e.donor(); }
+
+    // A matrix operand is used as is; an expression operand is evaluated into holder
+    template <class E>
+    const typename E::matrix_type& materialize(const E& e, optional<typename E::matrix_type>& holder) {
+        if constexpr (IsMatrix<E>::value) {
+            return e;
+        } else if constexpr (is_same_v<E, TempMatrix<typename E::matrix_type>>) {
+            return e.matrix();
+        } else {
+            holder.emplace(e);
+            return *holder;
         }
+    }
 
-        Matrix result(rows, other.cols);
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < other.cols; j++) {
-                for (int k = 0; k < cols; k++) {
-                    result.data[i][j] += this->data[i][k] * other.data[k][j];
-                }
+    // Evaluate e into dst, which already has the right shape and is not
+    // read by any product in e. Element-wise operands may alias dst; each
+    // chunk is then built in a scratch buffer before being written back.
+    template <class E, class M>
+    void evaluate(const E& e, M& dst) {
+        using T = typename M::value_type;
+        T* base = dst.rawData();
+        bool aliased = refersTo(e, &dst);
+        parallel::forRange((size_t)dst.getRows() * dst.getCols(), [&](size_t begin, size_t end) {
+            alignas(64) T scratch[CHUNK];
+            for (size_t pos = begin; pos < end; pos += CHUNK) {
+                size_t n = min(CHUNK, end - pos);
+                T* out = aliased ? scratch : base + pos;
+                bool written = false;
+                applyChunk(e, out, pos, n, false, written);
+                if (!written) fill_n(out, n, T(0)); // pure product: GEMM accumulates into zeros
+                if (aliased) copy_n(scratch, n, base + pos);
             }
+        });
+        applyProducts(e, dst, false);
+    }
+}
+
+template <class M>
+void TempMatrix<M>::applyChunk(value_type* out, size_t begin, size_t n, bool negate, bool& written) const {
+    expr::applyChunk(m, out, begin, n, negate, written);
+}
+
+template <class M>
+bool TempMatrix<M>::refersTo(const M* target) const {
+    return expr::refersTo(m, target);
+}
+
+// Node for A + B and A - B
+template <class L, class R, bool Subtract>
+class SumExpr : public MatrixExpr {
+private:
+    expr::Stored<L> left;
+    expr::Stored<R> right;
+    bool valid;
+
+public:
+    using matrix_type = typename L::matrix_type;
+    using value_type = typename matrix_type::value_type;
+
+    template <class A, class B>
+    SumExpr(A&& l, B&& r) : left(forward<A>(l)), right(forward<B>(r)) {
+        valid = expr::ok(left) && expr::ok(right);
+        if (valid && (left.getRows() != right.getRows() || left.getCols() != right.getCols())) {
+            cout << "Error: Matrix dimensions must match for " << (Subtract ? "subtraction" : "addition") << "." << endl;
+            valid = false;
         }
-        return result;
     }
 
-    // Check if matrix is valid (not empty)
-    bool isValid() const {
-        return rows > 0 && cols > 0;
+    bool ok() const { return valid; }
+    int getRows() const { return left.getRows(); }
+    int getCols() const { return left.getCols(); }
+
+    void applyChunk(value_type* out, size_t begin, size_t n, bool negate, bool& written) const {
+        expr::applyChunk(left, out, begin, n, negate, written);
+        expr::applyChunk(right, out, begin, n, negate != Subtract, written);
+    }
+
+    void applyProducts(matrix_type& dst, bool negate) const {
+        expr::applyProducts(left, dst, negate);
+        expr::applyProducts(right, dst, negate != Subtract);
+    }
+
+    bool refersTo(const matrix_type* target) const {
+        return expr::refersTo(left, target) || expr::refersTo(right, target);
+    }
+
+    bool productRefersTo(const matrix_type* target) const {
+        return expr::productRefersTo(left, target) || expr::productRefersTo(right, target);
+    }
+
+    matrix_type* donor() const {
+        matrix_type* d = expr::donor(left);
+        return d ? d : expr::donor(right);
+    }
+};
+
+// Node for A * B
+template <class L, class R>
+class ProductExpr : public MatrixExpr {
+private:
+    expr::Stored<L> left;
+    expr::Stored<R> right;
+    bool valid;
+
+public:
+    using matrix_type = typename L::matrix_type;
+    using value_type = typename matrix_type::value_type;
+
+    template <class A, class B>
+    ProductExpr(A&& l, B&& r) : left(forward<A>(l)), right(forward<B>(r)) {
+        valid = expr::ok(left) && expr::ok(right);
+        if (valid && left.getCols() != right.getRows()) {
+            cout << "Error: Cols of first matrix must equal rows of second for multiplication." << endl;
+            valid = false;
+        }
+    }
+
+    bool ok() const { return valid; }
+    int getRows() const { return left.getRows(); }
+    int getCols() const { return right.getCols(); }
+
+    // Products contribute nothing to the element-wise pass
+    void applyChunk(value_type*, size_t, size_t, bool, bool&) const {}
+
+    // dst (+/-)= left * right via the blocked (and threaded) GEMM, or via
+    // Strassen-Winograd for square inputs above the crossover size
+    void applyProducts(matrix_type& dst, bool negate) const {
+        using T = value_type;
+        using Acc = typename matrix_type::accumulator_type;
+        optional<matrix_type> leftHolder, rightHolder;
+        const matrix_type& a = expr::materialize(left, leftHolder);
+        const matrix_type& b = expr::materialize(right, rightHolder);
+        int n = a.getRows();
+        if (gemm::strassenCrossover > 0 && n > gemm::strassenCrossover
+            && a.getCols() == n && b.getCols() == n) {
+            matrix_type product(n, n);
+            gemm::strassenMultiply<T, Acc>(n, a.rawData(), b.rawData(), product.rawData(), gemm::strassenCrossover);
+            T* out = dst.rawData();
+            const T* p = product.rawData();
+            simd::ElementwiseFn<T> kernel = negate ? simd::active<T, Acc>().sub : simd::active<T, Acc>().add;
+            parallel::forRange((size_t)n * n, [=](size_t begin, size_t end) {
+                kernel(out + begin, p + begin, out + begin, end - begin);
+            });
+            return;
+        }
+        gemm::parallelMultiply<T, Acc>(a.getRows(), b.getCols(), a.getCols(),
+                                       a.rawData(), a.getCols(), b.rawData(), b.getCols(),
+                                       dst.rawData(), dst.getCols(), negate);
+    }
+
+    bool refersTo(const matrix_type* target) const {
+        return expr::refersTo(left, target) || expr::refersTo(right, target);
+    }
+
+    // GEMM reads its operands while writing dst, so any reference counts
+    bool productRefersTo(const matrix_type* target) const { return refersTo(target); }
+
+    // The product is accumulated into the destination, never into an operand
+    matrix_type* donor() const { return nullptr; }
+};
+
+template <class T, class Acc>
+template <class E> requires ExprOf<E, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc>& BasicMatrix<T, Acc>::operator=(E&& e) {
+    if (!expr::ok(e)) {
+        *this = BasicMatrix(0, 0); // Empty matrix on error, as before
+        return *this;
+    }
+    if (expr::productRefersTo(e, this)) {
+        BasicMatrix fresh(e); // e.g. A = A * B: GEMM can't write into its own input
+        *this = move(fresh);
+        return *this;
+    }
+    if (rows != e.getRows() || cols != e.getCols()) {
+        // Reuse the buffer when the shape already fits, else steal one from
+        // a temporary operand (only if the expression itself is a temporary,
+        // since the donor is left as a view of this matrix's storage)
+        BasicMatrix* d = is_lvalue_reference_v<E> ? nullptr : expr::donor(e);
+        if (d != nullptr) {
+            adoptBuffer(*d);
+        } else {
+            *this = BasicMatrix(e.getRows(), e.getCols());
+        }
+    }
+    expr::evaluate(e, *this);
+    return *this;
+}
+
+// Both operands must evaluate to the same matrix type
+template <class L, class R>
+concept CompatibleOperands = MatrixOperand<remove_cvref_t<L>> && OperandOf<R, typename remove_cvref_t<L>::matrix_type>;
+
+// Overloading the + operator for Matrix Addition
+template <class L, class R> requires CompatibleOperands<L, R>
+SumExpr<expr::OperandType<L>, expr::OperandType<R>, false> operator+(L&& l, R&& r) {
+    return SumExpr<expr::OperandType<L>, expr::OperandType<R>, false>(forward<L>(l), forward<R>(r));
+}
+
+// Overloading the - operator for Matrix Subtraction
+template <class L, class R> requires CompatibleOperands<L, R>
+SumExpr<expr::OperandType<L>, expr::OperandType<R>, true> operator-(L&& l, R&& r) {
+    return SumExpr<expr::OperandType<L>, expr::OperandType<R>, true>(forward<L>(l), forward<R>(r));
+}
+
+// Overloading the * operator for Matrix Multiplication
+template <class L, class R> requires CompatibleOperands<L, R>
+ProductExpr<expr::OperandType<L>, expr::OperandType<R>> operator*(L&& l, R&& r) {
+    return ProductExpr<expr::OperandType<L>, expr::OperandType<R>>(forward<L>(l), forward<R>(r));
+}
+
+template <class T, class Acc>
+template <class E> requires OperandOf<E, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc>& BasicMatrix<T, Acc>::operator+=(E&& e) {
+    auto sum = *this + forward<E>(e);
+    if (!sum.ok()) return *this; // error already reported; keep the old value
+    return *this = move(sum);
+}
+
+template <class T, class Acc>
+template <class E> requires OperandOf<E, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc>& BasicMatrix<T, Acc>::operator-=(E&& e) {
+    auto difference = *this - forward<E>(e);
+    if (!difference.ok()) return *this; // error already reported; keep the old value
+    return *this = move(difference);
+}
+
+template <class T, class Acc>
+template <class E> requires OperandOf<E, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc>& BasicMatrix<T, Acc>::operator*=(E&& e) {
+    auto product = *this * forward<E>(e);
+    if (!product.ok()) return *this; // error already reported; keep the old value
+    return *this = move(product);
+}
+
+// === Sparse Matrix (CSR) ===
+// Compressed Sparse Row storage for mostly-zero matrices: rowPtr[i] ..
+// rowPtr[i + 1] indexes the column/value pairs of row i. Memory and the cost
+// of every operation grow with the number of nonzeros rather than rows * cols.
+// Matrices are built from COO triplets (row, col, value) in any order;
+// duplicate entries are summed and explicit zeros dropped. Like the dense
+// matrix, the element type is a parameter and products are summed in Acc.
+template <class T>
+struct BasicTriplet {
+    int row;
+    int col;
+    T value;
+};
+
+using Triplet = BasicTriplet<int>;
+
+template <class T, class Acc = typename DefaultAccumulator<T>::type>
+class BasicSparseMatrix {
+    using Dense = BasicMatrix<T, Acc>;
+
+private:
+    int rows;
+    int cols;
+    vector<size_t> rowPtr; // rows + 1 offsets into colIdx / values
+    vector<int> colIdx;    // column of each nonzero, ascending within a row
+    vector<T> values;
+
+    // Split the rows into chunks holding roughly equal numbers of nonzeros
+    // and run fn(rowBegin, rowEnd) on each chunk across the thread pool.
+    void forRowsByNnz(const function<void(int, int)>& fn) const {
+        size_t total = nnz();
+        if (parallel::threadCount == 1 || total < parallel::MIN_ELEMENTS) {
+            fn(0, rows);
+            return;
+        }
+        int chunks = parallel::threadCount * 4;
+        auto rowAt = [&](int t) {
+            size_t target = total * t / chunks;
+            return (int)(lower_bound(rowPtr.begin(), rowPtr.end(), target) - rowPtr.begin());
+        };
+        parallel::getPool().parallelFor(chunks, [&](int t) {
+            int begin = t == 0 ? 0 : rowAt(t);
+            int end = t == chunks - 1 ? rows : rowAt(t + 1);
+            if (begin < end) fn(begin, end);
+        });
+    }
+
+public:
+    // All-zero r x c matrix
+    BasicSparseMatrix(int r, int c) : rows(max(r, 0)), cols(max(c, 0)), rowPtr(rows + 1, 0) {}
+
+    // COO ingest: bucket by row (counting sort), then sort each row by column
+    BasicSparseMatrix(int r, int c, const vector<BasicTriplet<T>>& entries) : BasicSparseMatrix(r, c) {
+        for (const auto& t : entries) {
+            if (t.row < 0 || t.row >= rows || t.col < 0 || t.col >= cols) {
+                cout << "Error: Entry (" << t.row << ", " << t.col << ") is outside a "
+                     << rows << "x" << cols << " matrix; ignored." << endl;
+                continue;
+            }
+            rowPtr[t.row + 1]++;
+        }
+        for (int i = 0; i < rows; i++) rowPtr[i + 1] += rowPtr[i];
+
+        vector<pair<int, T>> bucketed(rowPtr[rows]);
+        vector<size_t> next(rowPtr.begin(), rowPtr.end() - 1);
+        for (const auto& t : entries) {
+            if (t.row < 0 || t.row >= rows || t.col < 0 || t.col >= cols) continue;
+            bucketed[next[t.row]++] = {t.col, t.value};
+        }
+
+        // Sort each row by column, sum duplicates and drop zeros, compacting in place
+        colIdx.reserve(bucketed.size());
+        values.reserve(bucketed.size());
+        size_t start = 0;
+        for (int i = 0; i < rows; i++) {
+            size_t end = rowPtr[i + 1];
+            size_t rowStart = colIdx.size();
+            sort(bucketed.begin() + start, bucketed.begin() + end);
+            for (size_t p = start; p < end; p++) {
+                if (colIdx.size() > rowStart && colIdx.back() == bucketed[p].first) {
+                    values.back() += bucketed[p].second;
+                } else {
+                    colIdx.push_back(bucketed[p].first);
+                    values.push_back(bucketed[p].second);
+                }
+            }
+            size_t kept = rowStart;
+            for (size_t p = rowStart; p < colIdx.size(); p++) {
+                if (values[p] != 0) {
+                    colIdx[kept] = colIdx[p];
+                    values[kept] = values[p];
+                    kept++;
+                }
+            }
+            colIdx.resize(kept);
+            values.resize(kept);
+            rowPtr[i + 1] = kept;
+            start = end;
+        }
+    }
+
+    // Convert the nonzeros of a dense matrix
+    explicit BasicSparseMatrix(const Dense& dense) : BasicSparseMatrix(dense.getRows(), dense.getCols()) {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                if (dense.at(i, j) != 0) {
+                    colIdx.push_back(j);
+                    values.push_back(dense.at(i, j));
+                }
+            }
+            rowPtr[i + 1] = colIdx.size();
+        }
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    size_t nnz() const { return values.size(); }
+    bool isValid() const { return rows > 0 && cols > 0; }
+
+    // Bytes held by the CSR arrays
+    size_t memoryBytes() const {
+        return rowPtr.size() * sizeof(size_t) + colIdx.size() * sizeof(int) + values.size() * sizeof(T);
+    }
+
+    Dense toDense() const {
+        Dense dense(rows, cols);
+        for (int i = 0; i < rows; i++) {
+            for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) dense.at(i, colIdx[p]) = values[p];
+        }
+        return dense;
+    }
+
+    // Lists the nonzeros; all other entries are zero
+    void display() const {
+        cout << rows << "x" << cols << " sparse matrix, " << nnz() << " nonzeros" << endl;
+        for (int i = 0; i < rows; i++) {
+            for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) {
+                cout << "  [" << i << "][" << colIdx[p] << "] = " << values[p] << endl;
+            }
+        }
+    }
+
+    // Sparse matrix * dense vector, rows split across the pool by nonzero count
+    vector<T> multiply(const vector<T>& x) const {
+        if ((int)x.size() != cols) {
+            cout << "Error: Vector length must equal matrix cols for multiplication." << endl;
+            return {};
+        }
+        vector<T> y(rows, T(0));
+        forRowsByNnz([&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                Acc sum = 0;
+                for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) sum += (Acc)values[p] * x[colIdx[p]];
+                y[i] = (T)sum;
+            }
+        });
+        return y;
+    }
+
+    // Row-by-row merge of two sorted sparse rows; sign is -1 for subtraction
+    BasicSparseMatrix merge(const BasicSparseMatrix& other, int sign) const {
+        BasicSparseMatrix result(rows, cols);
+        result.colIdx.reserve(nnz() + other.nnz());
+        result.values.reserve(nnz() + other.nnz());
+        for (int i = 0; i < rows; i++) {
+            size_t p = rowPtr[i], q = other.rowPtr[i];
+            while (p < rowPtr[i + 1] || q < other.rowPtr[i + 1]) {
+                int col;
+                T value;
+                if (q == other.rowPtr[i + 1] || (p < rowPtr[i + 1] && colIdx[p] < other.colIdx[q])) {
+                    col = colIdx[p];
+                    value = values[p++];
+                } else if (p == rowPtr[i + 1] || other.colIdx[q] < colIdx[p]) {
+                    col = other.colIdx[q];
+                    value = (T)sign * other.values[q++];
+                } else {
+                    col = colIdx[p];
+                    value = values[p++] + (T)sign * other.values[q++];
+                }
+                if (value != 0) {
+                    result.colIdx.push_back(col);
+                    result.values.push_back(value);
+                }
+            }
+            result.rowPtr[i + 1] = result.colIdx.size();
+        }
+        return result;
+    }
+
+    // Sparse * sparse (Gustavson): each output row is accumulated in a dense
+    // scratch row, touching only the columns reached through nonzeros.
+    BasicSparseMatrix multiplySparse(const BasicSparseMatrix& other) const {
+        BasicSparseMatrix result(rows, other.cols);
+        vector<Acc> acc(other.cols, 0);
+        vector<char> seen(other.cols, 0);
+        vector<int> touched;
+        for (int i = 0; i < rows; i++) {
+            for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) {
+                int k = colIdx[p];
+                Acc a = values[p];
+                for (size_t q = other.rowPtr[k]; q < other.rowPtr[k + 1]; q++) {
+                    int j = other.colIdx[q];
+                    if (!seen[j]) {
+                        seen[j] = 1;
+                        touched.push_back(j);
+                    }
+                    acc[j] += a * other.values[q];
+                }
+            }
+            sort(touched.begin(), touched.end());
+            for (int j : touched) {
+                T value = (T)acc[j];
+                if (value != 0) {
+                    result.colIdx.push_back(j);
+                    result.values.push_back(value);
+                }
+                acc[j] = 0;
+                seen[j] = 0;
+            }
+            touched.clear();
+            result.rowPtr[i + 1] = result.colIdx.size();
+        }
+        return result;
+    }
+
+    // Sparse * dense: each nonzero (i, k) adds value * B[k, :] into row i,
+    // summed in an Acc scratch row
+    Dense multiplyDense(const Dense& b) const {
+        Dense result(rows, b.getCols());
+        int n = b.getCols();
+        forRowsByNnz([&](int begin, int end) {
+            vector<Acc> acc(n);
+            for (int i = begin; i < end; i++) {
+                fill(acc.begin(), acc.end(), Acc(0));
+                for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) {
+                    const T* in = b.rawData() + (size_t)colIdx[p] * n;
+                    Acc v = values[p];
+                    for (int j = 0; j < n; j++) acc[j] += v * in[j];
+                }
+                T* out = result.rawData() + (size_t)i * n;
+                for (int j = 0; j < n; j++) out[j] = (T)acc[j];
+            }
+        });
+        return result;
+    }
+
+    // Dense * sparse: each nonzero A[i, k] scatters A[i, k] * row k of this
+    // into an Acc scratch row
+    Dense multiplyByDense(const Dense& a) const {
+        Dense result(a.getRows(), cols);
+        parallel::forRange(a.getRows(), [&](size_t begin, size_t end) {
+            vector<Acc> acc(cols);
+            for (size_t i = begin; i < end; i++) {
+                fill(acc.begin(), acc.end(), Acc(0));
+                for (int k = 0; k < rows; k++) {
+                    Acc av = a.at((int)i, k);
+                    if (av == 0) continue;
+                    for (size_t p = rowPtr[k]; p < rowPtr[k + 1]; p++) acc[colIdx[p]] += av * values[p];
+                }
+                T* out = result.rawData() + i * cols;
+                for (int j = 0; j < cols; j++) out[j] = (T)acc[j];
+            }
+        });
+        return result;
+    }
+
+    // dense (+/-)= this, only touching stored nonzeros
+    void scatterInto(Dense& dense, int sign) const {
+        for (int i = 0; i < rows; i++) {
+            for (size_t p = rowPtr[i]; p < rowPtr[i + 1]; p++) dense.at(i, colIdx[p]) += (T)sign * values[p];
+        }
+    }
+};
+
+using SparseMatrix = BasicSparseMatrix<int>;
+
+// --- Sparse operators ---
+// Sparse with sparse stays sparse; any dense operand (a Matrix or a lazy
+// expression, evaluated first) makes the result a dense Matrix.
+
+template <class T, class Acc>
+BasicSparseMatrix<T, Acc> operator+(const BasicSparseMatrix<T, Acc>& a, const BasicSparseMatrix<T, Acc>& b) {
+    if (a.getRows() != b.getRows() || a.getCols() != b.getCols()) {
+        cout << "Error: Matrix dimensions must match for addition." << endl;
+        return BasicSparseMatrix<T, Acc>(0, 0);
+    }
+    return a.merge(b, 1);
+}
+
+template <class T, class Acc>
+BasicSparseMatrix<T, Acc> operator-(const BasicSparseMatrix<T, Acc>& a, const BasicSparseMatrix<T, Acc>& b) {
+    if (a.getRows() != b.getRows() || a.getCols() != b.getCols()) {
+        cout << "Error: Matrix dimensions must match for subtraction." << endl;
+        return BasicSparseMatrix<T, Acc>(0, 0);
+    }
+    return a.merge(b, -1);
+}
+
+template <class T, class Acc>
+BasicSparseMatrix<T, Acc> operator*(const BasicSparseMatrix<T, Acc>& a, const BasicSparseMatrix<T, Acc>& b) {
+    if (a.getCols() != b.getRows()) {
+        cout << "Error: Cols of first matrix must equal rows of second for multiplication." << endl;
+        return BasicSparseMatrix<T, Acc>(0, 0);
+    }
+    return a.multiplySparse(b);
+}
+
+template <class T, class Acc>
+vector<T> operator*(const BasicSparseMatrix<T, Acc>& a, const vector<T>& x) {
+    return a.multiply(x);
+}
+
+template <class D, class T, class Acc> requires OperandOf<D, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc> operator+(const D& d, const BasicSparseMatrix<T, Acc>& s) {
+    BasicMatrix<T, Acc> result(d);
+    if (result.getRows() != s.getRows() || result.getCols() != s.getCols()) {
+        cout << "Error: Matrix dimensions must match for addition." << endl;
+        return BasicMatrix<T, Acc>(0, 0);
+    }
+    s.scatterInto(result, 1);
+    return result;
+}
+
+template <class D, class T, class Acc> requires OperandOf<D, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc> operator+(const BasicSparseMatrix<T, Acc>& s, const D& d) {
+    return d + s;
+}
+
+template <class D, class T, class Acc> requires OperandOf<D, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc> operator-(const D& d, const BasicSparseMatrix<T, Acc>& s) {
+    BasicMatrix<T, Acc> result(d);
+    if (result.getRows() != s.getRows() || result.getCols() != s.getCols()) {
+        cout << "Error: Matrix dimensions must match for subtraction." << endl;
+        return BasicMatrix<T, Acc>(0, 0);
+    }
+    s.scatterInto(result, -1);
+    return result;
+}
+
+template <class D, class T, class Acc> requires OperandOf<D, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc> operator-(const BasicSparseMatrix<T, Acc>& s, const D& d) {
+    BasicMatrix<T, Acc> result(s.getRows(), s.getCols());
+    result = result - d; // -d, dimension checked by the expression
+    if (result.isValid()) s.scatterInto(result, 1);
+    return result;
+}
+
+template <class D, class T, class Acc> requires OperandOf<D, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc> operator*(const BasicSparseMatrix<T, Acc>& s, const D& d) {
+    optional<BasicMatrix<T, Acc>> holder;
+    const BasicMatrix<T, Acc>& b = expr::materialize(d, holder);
+    if (s.getCols() != b.getRows()) {
+        cout << "Error: Cols of first matrix must equal rows of second for multiplication." << endl;
+        return BasicMatrix<T, Acc>(0, 0);
+    }
+    return s.multiplyDense(b);
+}
+
+template <class D, class T, class Acc> requires OperandOf<D, BasicMatrix<T, Acc>>
+BasicMatrix<T, Acc> operator*(const D& d, const BasicSparseMatrix<T, Acc>& s) {
+    optional<BasicMatrix<T, Acc>> holder;
+    const BasicMatrix<T, Acc>& a = expr::materialize(d, holder);
+    if (a.getCols() != s.getRows()) {
+        cout << "Error: Cols of first matrix must equal rows of second for multiplication." << endl;
+        return BasicMatrix<T, Acc>(0, 0);
+    }
+    return s.multiplyByDense(a);
+}
+
+// === Fixed-Size Matrix ===
+// For small transforms (2x2 .. 8x8) the dimensions are template parameters:
+// elements live inline (no heap), every operation is constexpr, and the
+// add/multiply loops are fully unrolled at compile time with fold
+// expressions, so a 4x4 product compiles to straight-line code.
+// Converts to and from the dynamic matrix of the same element type for mixed use.
+template <int R, int C, class T = int>
+class FixedMatrix {
+    static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+private:
+    T data[R * C] = {};
+
+    // Row i of a times column j of b, unrolled over the shared dimension
+    template <int K, size_t... P>
+    static constexpr T dot(const FixedMatrix& a, const FixedMatrix<C, K, T>& b, int i, int j, index_sequence<P...>) {
+        return ((a.at(i, (int)P) * b.at((int)P, j)) + ...);
+    }
+
+public:
+    constexpr FixedMatrix() = default;
+
+    // Row-major element list; missing trailing elements are zero
+    constexpr FixedMatrix(initializer_list<T> values) {
+        int i = 0;
+        for (T v : values) {
+            if (i < R * C) data[i++] = v;
+        }
+    }
+
+    // Copy a dynamic matrix of the same shape (zeros and a message otherwise)
+    template <class Acc>
+    explicit FixedMatrix(const BasicMatrix<T, Acc>& m) {
+        if (m.getRows() != R || m.getCols() != C) {
+            cout << "Error: Matrix is " << m.getRows() << "x" << m.getCols()
+                 << ", expected " << R << "x" << C << "." << endl;
+            return;
+        }
+        copy_n(m.rawData(), R * C, data);
+    }
+
+    template <class Acc = typename DefaultAccumulator<T>::type>
+    BasicMatrix<T, Acc> toMatrix() const {
+        BasicMatrix<T, Acc> m(R, C);
+        copy_n(data, R * C, m.rawData());
+        return m;
+    }
+
+    static constexpr int rows() { return R; }
+    static constexpr int cols() { return C; }
+
+    constexpr T& at(int i, int j) { return data[i * C + j]; }
+    constexpr T at(int i, int j) const { return data[i * C + j]; }
+
+    void display() const {
+        for (int i = 0; i < R; i++) {
+            cout << "| ";
+            for (int j = 0; j < C; j++) cout << setw(4) << at(i, j) << " ";
+            cout << "|" << endl;
+        }
+    }
+
+    constexpr friend FixedMatrix operator+(const FixedMatrix& a, const FixedMatrix& b) {
+        FixedMatrix out;
+        [&]<size_t... I>(index_sequence<I...>) {
+            ((out.data[I] = a.data[I] + b.data[I]), ...);
+        }(make_index_sequence<R * C>{});
+        return out;
+    }
+
+    constexpr friend FixedMatrix operator-(const FixedMatrix& a, const FixedMatrix& b) {
+        FixedMatrix out;
+        [&]<size_t... I>(index_sequence<I...>) {
+            ((out.data[I] = a.data[I] - b.data[I]), ...);
+        }(make_index_sequence<R * C>{});
+        return out;
+    }
+
+    // (R x C) * (C x K): one unrolled dot product per output element
+    template <int K>
+    constexpr friend FixedMatrix<R, K, T> operator*(const FixedMatrix& a, const FixedMatrix<C, K, T>& b) {
+        FixedMatrix<R, K, T> out;
+        [&]<size_t... I>(index_sequence<I...>) {
+            ((out.at(I / K, I % K) = dot(a, b, I / K, I % K, make_index_sequence<C>{})), ...);
+        }(make_index_sequence<R * K>{});
+        return out;
+    }
+
+    constexpr friend bool operator==(const FixedMatrix& a, const FixedMatrix& b) {
+        for (int i = 0; i < R * C; i++) {
+            if (a.data[i] != b.data[i]) return false;
+        }
+        return true;
     }
 };
 
-int main() {
+// --- Mixed fixed / dynamic operators ---
+// The fixed operand is converted, so these return an ordinary Matrix and
+// report dimension errors the same way the dynamic operators do.
+
+template <int R, int C, class T, class Acc>
+BasicMatrix<T, Acc> operator+(const FixedMatrix<R, C, T>& f, const BasicMatrix<T, Acc>& m) { return f.template toMatrix<Acc>() + m; }
+
+template <int R, int C, class T, class Acc>
+BasicMatrix<T, Acc> operator+(const BasicMatrix<T, Acc>& m, const FixedMatrix<R, C, T>& f) { return m + f.template toMatrix<Acc>(); }
+
+template <int R, int C, class T, class Acc>
+BasicMatrix<T, Acc> operator-(const FixedMatrix<R, C, T>& f, const BasicMatrix<T, Acc>& m) { return f.template toMatrix<Acc>() - m; }
+
+template <int R, int C, class T, class Acc>
+BasicMatrix<T, Acc> operator-(const BasicMatrix<T, Acc>& m, const FixedMatrix<R, C, T>& f) { return m - f.template toMatrix<Acc>(); }
+
+template <int R, int C, class T, class Acc>
+BasicMatrix<T, Acc> operator*(const FixedMatrix<R, C, T>& f, const BasicMatrix<T, Acc>& m) { return f.template toMatrix<Acc>() * m; }
+
+template <int R, int C, class T, class Acc>
+BasicMatrix<T, Acc> operator*(const BasicMatrix<T, Acc>& m, const FixedMatrix<R, C, T>& f) { return m * f.template toMatrix<Acc>(); }
+
+// Evaluated entirely at compile time
+static_assert(FixedMatrix<2, 2>{1, 2, 3, 4} * FixedMatrix<2, 2>{5, 6, 7, 8} == FixedMatrix<2, 2>{19, 22, 43, 50});
+
+// === Binary Matrix Files ===
+// Non-interactive format for large inputs: a 64-byte header followed by
+// rows * cols raw elements (of the type given by dtype), row-major,
+// little-endian. The header size keeps
+// the data cache-line aligned inside a page-aligned mapping, so inputs are
+// used in place through mmap and results are evaluated straight into a
+// mapped output file. No element is ever parsed or copied through a stream.
+namespace matfile {
+    const char MAGIC[8] = {'M', 'A', 'T', 'R', 'I', 'X', '0', '1'};
+
+    struct Header {
+        char magic[8];
+        uint32_t dtype; // DTYPE_* code of the elements
+        uint32_t rows;
+        uint32_t cols;
+        uint8_t reserved[44];
+    };
+    static_assert(sizeof(Header) == 64, "data must start on a cache-line boundary");
+
+    // RAII wrapper around an open file and its mapping. A created file is
+    // written under a temporary name and only replaces its real path on
+    // commit(), so an output that is also an input is never truncated
+    // while the input is still being read, and a failed run leaves no
+    // half-written file behind.
+    class MappedFile {
+    private:
+        int fd = -1;
+        void* addr = MAP_FAILED;
+        size_t length = 0;
+        string finalPath, tempPath; // set by create() until committed
+
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            if (addr != MAP_FAILED) munmap(addr, length);
+            if (fd >= 0) close(fd);
+            if (!tempPath.empty()) unlink(tempPath.c_str());
+        }
+
+        // Map an existing file copy-on-write, so views of it are writable
+        // without ever touching the file on disk
+        bool openRead(const string& path) {
+            fd = open(path.c_str(), O_RDONLY);
+            struct stat st;
+            if (fd < 0 || fstat(fd, &st) != 0) return false;
+            length = (size_t)st.st_size;
+            if (length == 0) return false;
+            addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            return addr != MAP_FAILED;
+        }
+
+        // Create a temporary file of the given size next to path and map
+        // it shared; commit() moves it into place
+        bool create(const string& path, size_t size) {
+            finalPath = path;
+            tempPath = path + ".tmp." + to_string(getpid());
+            fd = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0 || ftruncate(fd, (off_t)size) != 0) return false;
+            length = size;
+            addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            return addr != MAP_FAILED;
+        }
+
+        // Replace the real path with the finished file. Inputs mapped from
+        // the old file keep reading its (now unlinked) contents.
+        bool commit() {
+            if (rename(tempPath.c_str(), finalPath.c_str()) != 0) {
+                cout << "Error: Cannot write matrix file " << finalPath << endl;
+                return false;
+            }
+            tempPath.clear();
+            return true;
+        }
+
+        char* bytes() const { return static_cast<char*>(addr); }
+        size_t size() const { return length; }
+    };
+
+    // Element type code in a file's header, or 0 if it isn't a matrix file
+    uint32_t fileDtype(const string& path) {
+        MappedFile file;
+        if (!file.openRead(path) || file.size() < sizeof(Header)) return 0;
+        Header h;
+        memcpy(&h, file.bytes(), sizeof(Header));
+        return memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 ? h.dtype : 0;
+    }
+
+    // Map a matrix file and return a view over its data, or an empty
+    // matrix (with a message) if the file is missing or malformed
+    template <class T>
+    BasicMatrix<T> load(const string& path, MappedFile& file) {
+        if (!file.openRead(path) || file.size() < sizeof(Header)) {
+            cout << "Error: Cannot read matrix file " << path << endl;
+            return BasicMatrix<T>(0, 0);
+        }
+        Header h;
+        memcpy(&h, file.bytes(), sizeof(Header));
+        if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.dtype != dtypeOf<T>()) {
+            cout << "Error: " << path << " is not a matrix file of " << typeName<T>() << " elements." << endl;
+            return BasicMatrix<T>(0, 0);
+        }
+        // A corrupt header can claim dimensions whose byte count wraps
+        // round to something small, so check the product doesn't overflow
+        size_t elements, dataBytes, needed;
+        bool overflow = __builtin_mul_overflow((size_t)h.rows, (size_t)h.cols, &elements)
+                        || __builtin_mul_overflow(elements, sizeof(T), &dataBytes)
+                        || __builtin_add_overflow(dataBytes, sizeof(Header), &needed);
+        if (overflow || h.rows > (uint32_t)numeric_limits<int>::max() || h.cols > (uint32_t)numeric_limits<int>::max()
+            || file.size() < needed) {
+            cout << "Error: " << path << " is truncated." << endl;
+            return BasicMatrix<T>(0, 0);
+        }
+        return BasicMatrix<T>::view((int)h.rows, (int)h.cols, reinterpret_cast<T*>(file.bytes() + sizeof(Header)));
+    }
+
+    // Create a rows x cols matrix file and return a view over its data
+    template <class T>
+    BasicMatrix<T> create(const string& path, int rows, int cols, MappedFile& file) {
+        size_t bytes = sizeof(Header) + (size_t)rows * cols * sizeof(T);
+        if (!file.create(path, bytes)) {
+            cout << "Error: Cannot create matrix file " << path << endl;
+            return BasicMatrix<T>(0, 0);
+        }
+        Header h = {};
+        memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.dtype = dtypeOf<T>();
+        h.rows = (uint32_t)rows;
+        h.cols = (uint32_t)cols;
+        memcpy(file.bytes(), &h, sizeof(Header));
+        return BasicMatrix<T>::view(rows, cols, reinterpret_cast<T*>(file.bytes() + sizeof(Header)));
+    }
+
+    // Evaluate an expression straight into a newly created output file
+    template <class E>
+    bool evaluateTo(const string& path, const E& e) {
+        if (!expr::ok(e)) return false;
+        using M = typename E::matrix_type;
+        MappedFile file;
+        M out = create<typename M::value_type>(path, e.getRows(), e.getCols(), file);
+        if (!out.isValid()) return false;
+        out = e;
+        return file.commit();
+    }
+
+    template <class T>
+    int runTyped(const string& op, const string& pathA, const string& pathB, const string& pathOut) {
+        MappedFile fileA, fileB;
+        BasicMatrix<T> a = load<T>(pathA, fileA);
+        BasicMatrix<T> b = load<T>(pathB, fileB);
+        if (!a.isValid() || !b.isValid()) return 1;
+
+        auto start = chrono::steady_clock::now();
+        bool ok;
+        if (op == "add") {
+            ok = evaluateTo(pathOut, a + b);
+        } else if (op == "sub") {
+            ok = evaluateTo(pathOut, a - b);
+        } else if (op == "mul") {
+            ok = evaluateTo(pathOut, a * b);
+        } else {
+            cout << "Error: Unknown operation '" << op << "' (use add, sub or mul)." << endl;
+            return 1;
+        }
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        if (!ok) return 1;
+
+        cout << op << " (" << typeName<T>() << "): " << a.getRows() << "x" << a.getCols() << " and " << b.getRows() << "x" << b.getCols()
+             << " -> " << pathOut << " in " << fixed << setprecision(2) << elapsed.count() << " ms" << endl;
+        return 0;
+    }
+
+    // --file OP A B OUT: run add / sub / mul on two matrix files, in the
+    // element type recorded in A (B must match)
+    int run(const string& op, const string& pathA, const string& pathB, const string& pathOut) {
+        int status = 1;
+        bool known = withElementType(fileDtype(pathA), [&](auto tag) {
+            status = runTyped<decltype(tag)>(op, pathA, pathB, pathOut);
+        });
+        if (!known) cout << "Error: Cannot read matrix file " << pathA << endl;
+        return status;
+    }
+
+    // --make-file R C PATH: write a random matrix, handy for producing inputs
+    template <class T>
+    int makeRandom(int rows, int cols, const string& path) {
+        MappedFile file;
+        BasicMatrix<T> m = create<T>(path, rows, cols, file);
+        if (!m.isValid()) return 1;
+        m.randomize();
+        return file.commit() ? 0 : 1;
+    }
+}
+
+
+// === Benchmark ===
+// Times A * B for square sizes 64..4096 and reports throughput.
+// Each size is repeated until at least ~0.5s has elapsed to smooth out noise.
+template <class T>
+void runGemmBenchmark() {
+    using Acc = typename DefaultAccumulator<T>::type;
+    cout << "=== Blocked GEMM Benchmark (" << typeName<T>() << ", " << simd::active<T, Acc>().name << ") ===" << endl;
+    cout << left << setw(8) << "Size" << setw(12) << "Time (ms)" << "GFLOP/s" << endl;
+    int saved = gemm::strassenCrossover; // GFLOP/s below assume the 2n^3 blocked kernel
+    gemm::strassenCrossover = 0;
+
+    for (int n = 64; n <= 4096; n *= 2) {
+        BasicMatrix<T> a(n, n), b(n, n);
+        a.randomize();
+        b.randomize();
+
+        int reps = 0;
+        auto start = chrono::steady_clock::now();
+        chrono::duration<double> elapsed{};
+        do {
+            BasicMatrix<T> c = a * b;
+            reps++;
+            elapsed = chrono::steady_clock::now() - start;
+        } while (elapsed.count() < 0.5);
+
+        double seconds = elapsed.count() / reps;
+        double gflops = 2.0 * n * n * n / seconds / 1e9;
+        cout << left << setw(8) << n << setw(12) << fixed << setprecision(2) << seconds * 1000
+             << setprecision(2) << gflops << endl;
+    }
+    gemm::strassenCrossover = saved;
+}
+
+// Sparse n x n matrices with a fixed number of nonzeros per row: memory and
+// SpMV / SpGEMM time should grow with nnz, not with n * n.
+void runSparseBenchmark() {
+    const int perRow = 4;
+    cout << "=== Sparse CSR Benchmark (" << perRow << " nonzeros/row) ===" << endl;
+    cout << left << setw(10) << "Size" << setw(12) << "NNZ" << setw(14) << "CSR (MB)" << setw(14) << "Dense (MB)"
+         << setw(12) << "SpMV (ms)" << setw(14) << "SpGEMM (ms)" << "Result NNZ" << endl;
+
+    mt19937 rng(42);
+    for (int n = 10000; n <= 1000000; n *= 10) {
+        vector<Triplet> entries;
+        entries.reserve((size_t)n * perRow);
+        for (int i = 0; i < n; i++) {
+            for (int k = 0; k < perRow; k++) entries.push_back({i, (int)(rng() % n), 1 + (int)(rng() % 9)});
+        }
+        SparseMatrix s(n, n, entries);
+        vector<int> x(n, 1);
+
+        auto start = chrono::steady_clock::now();
+        const int spmvReps = 20;
+        for (int r = 0; r < spmvReps; r++) {
+            vector<int> y = s * x;
+        }
+        chrono::duration<double, milli> spmv = chrono::steady_clock::now() - start;
+
+        start = chrono::steady_clock::now();
+        SparseMatrix product = s * s;
+        chrono::duration<double, milli> spgemm = chrono::steady_clock::now() - start;
+
+        double denseMb = (double)n * n * sizeof(int) / (1 << 20);
+        cout << left << setw(10) << n << setw(12) << s.nnz() << setw(14) << fixed << setprecision(2)
+             << s.memoryBytes() / double(1 << 20) << setw(14) << setprecision(0) << denseMb
+             << setw(12) << setprecision(3) << spmv.count() / spmvReps << setw(14) << setprecision(2)
+             << spgemm.count() << product.nnz() << endl;
+    }
+}
+
+// Finds the Strassen crossover on this machine: at each size, one level of
+// Strassen-Winograd (crossover = n / 2) is timed against the blocked kernel.
+// The suggested crossover is the largest size at which blocked still wins.
+void runStrassenBenchmark() {
+    cout << "=== Strassen-Winograd Crossover Search ===" << endl;
+    cout << left << setw(8) << "Size" << setw(14) << "Blocked (ms)" << setw(16) << "1-level (ms)" << "Speedup" << endl;
+
+    auto bestOf3 = [](const Matrix& a, const Matrix& b, int crossover) {
+        gemm::strassenCrossover = crossover;
+        double best = numeric_limits<double>::max();
+        for (int rep = 0; rep < 3; rep++) {
+            auto start = chrono::steady_clock::now();
+            Matrix c = a * b;
+            chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+            best = min(best, elapsed.count());
+        }
+        return best;
+    };
+
+    int saved = gemm::strassenCrossover;
+    int suggested = 0;
+    for (int n : {128, 192, 256, 384, 512, 768, 1024, 1536, 2048}) {
+        Matrix a(n, n), b(n, n);
+        a.randomize();
+        b.randomize();
+        double blocked = bestOf3(a, b, 0);
+        double strassen = bestOf3(a, b, n / 2);
+        if (strassen >= blocked) suggested = n;
+        cout << left << setw(8) << n << setw(14) << fixed << setprecision(2) << blocked
+             << setw(16) << strassen << blocked / strassen << endl;
+    }
+    gemm::strassenCrossover = saved;
+    cout << "Suggested crossover: " << suggested << " (run with --strassen " << suggested << ")" << endl;
+}
+
+// Millions of N x N multiplies per second, FixedMatrix against Matrix.
+// Each iteration perturbs an input so the work can't be hoisted out of the loop.
+template <int N>
+void benchSmallMultiply(int iterations) {
+    // 16 different inputs, and a result element picked at run time, so the
+    // compiler can neither hoist the multiply nor compute just one entry
+    const int VARIANTS = 16;
+    vector<FixedMatrix<N, N>> fixedInputs(VARIANTS);
+    vector<Matrix> dynamicInputs(VARIANTS, Matrix(N, N));
+    for (int v = 0; v < VARIANTS; v++) {
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                fixedInputs[v].at(i, j) = dynamicInputs[v].at(i, j) = rand() % 10;
+            }
+        }
+    }
+    const FixedMatrix<N, N>& fb = fixedInputs[0];
+    const Matrix& db = dynamicInputs[0];
+
+    long long sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        FixedMatrix<N, N> c = fixedInputs[it % VARIANTS] * fb;
+        sink += c.at(it % N, (it >> 4) % N);
+    }
+    chrono::duration<double> fixedTime = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        Matrix c = dynamicInputs[it % VARIANTS] * db;
+        sink -= c.at(it % N, (it >> 4) % N);
+    }
+    chrono::duration<double> dynamicTime = chrono::steady_clock::now() - start;
+
+    double fixedRate = iterations / fixedTime.count() / 1e6;
+    double dynamicRate = iterations / dynamicTime.count() / 1e6;
+    cout << left << setw(8) << (to_string(N) + "x" + to_string(N)) << setw(16) << fixed << setprecision(2)
+         << fixedRate << setw(16) << dynamicRate << setw(10) << fixedRate / dynamicRate
+         << (sink == 0 ? "results match" : "RESULTS DIFFER") << endl;
+}
+
+void runSmallMatrixBenchmark() {
+    const int iterations = 2000000;
+    cout << "=== Small Matrix Multiply (million/s, " << iterations << " each) ===" << endl;
+    cout << left << setw(8) << "Size" << setw(16) << "FixedMatrix" << setw(16) << "Matrix" << "Speedup" << endl;
+    benchSmallMultiply<2>(iterations);
+    benchSmallMultiply<3>(iterations);
+    benchSmallMultiply<4>(iterations);
+    benchSmallMultiply<8>(iterations);
+}
+
+// Counts Matrix storage allocations for common expression shapes, to show
+// that chains are evaluated into a single buffer and temporaries are reused.
+void runAllocationReport() {
+    const int n = 256;
+    Matrix a(n, n), b(n, n), c(n, n), r(n, n);
+    a.randomize();
+    b.randomize();
+    c.randomize();
+
+    cout << "=== Matrix Allocations per Expression (" << n << "x" << n << ") ===" << endl;
+    auto report = [](const string& label, const function<void()>& fn) {
+        size_t before = Matrix::allocationCount();
+        fn();
+        cout << left << setw(34) << label << Matrix::allocationCount() - before << endl;
+    };
+
+    report("Matrix x = (A + B) + C", [&] { Matrix x = (a + b) + c; });
+    report("Matrix x = A * B + C", [&] { Matrix x = a * b + c; });
+    report("Matrix x = Matrix(A + B) + C", [&] { Matrix x = Matrix(a + b) + c; });
+    report("Matrix x = C - Matrix(A * B)", [&] { Matrix x = c - Matrix(a * b); });
+    report("R = A + B - C  (R already sized)", [&] { r = a + b - c; });
+    report("R = A * B + C  (R already sized)", [&] { r = a * b + c; });
+    report("R += A", [&] { r += a; });
+    report("R -= A + B", [&] { r -= a + b; });
+    report("R *= A", [&] { r *= a; });
+}
+
+
+// === SIMD Self-Test ===
+// Checks every kernel set this CPU supports against the scalar path, for
+// each element type: add/sub for every tail length up to a few vectors, and
+// whole blocked multiplies of odd shapes, which cover packing, ragged edge
+// tiles and more than one KC panel. Integer results must be bit-exact (with
+// full-range values, so overflow wrapping is exercised); floating-point
+// products may differ by rounding, within a bound that grows with k.
+template <class T, class Acc>
+bool selfTestType(const string& label) {
+    mt19937 rng(12345);
+    auto randomVector = [&](size_t n) {
+        vector<T> v(n);
+        if constexpr (is_integral_v<T>) {
+            uniform_int_distribution<T> any(numeric_limits<T>::min(), numeric_limits<T>::max());
+            for (auto& x : v) x = any(rng);
+        } else {
+            uniform_real_distribution<T> unit(-1, 1);
+            for (auto& x : v) x = unit(rng);
+        }
+        return v;
+    };
+    // |error| <= tolerance per element (always exact for integers)
+    auto matches = [](const vector<T>& expected, const vector<T>& actual, double tolerance) {
+        if constexpr (is_integral_v<T>) {
+            return expected == actual;
+        } else {
+            for (size_t i = 0; i < expected.size(); i++) {
+                if (fabs((double)expected[i] - (double)actual[i]) > tolerance) return false;
+            }
+            return true;
+        }
+    };
+
+    vector<simd::KernelSet<T>> sets = simd::supported<T, Acc>();
+    const simd::KernelSet<T>& ref = sets.front();
+    bool allPassed = true;
+
+    for (const auto& set : sets) {
+        bool ok = true;
+
+        // Element-wise add/sub for every tail length up to a few vectors
+        for (size_t n = 0; n <= 67; n++) {
+            vector<T> a = randomVector(n), b = randomVector(n);
+            vector<T> expected(n), actual(n);
+            ref.add(a.data(), b.data(), expected.data(), n);
+            set.add(a.data(), b.data(), actual.data(), n);
+            ok = ok && matches(expected, actual, 0);
+            ref.sub(a.data(), b.data(), expected.data(), n);
+            set.sub(a.data(), b.data(), actual.data(), n);
+            ok = ok && matches(expected, actual, 0);
+        }
+
+        // C (+/-)= A * B through the blocked kernel, C starting non-zero
+        for (int trial = 0; trial < 40; trial++) {
+            int m = 1 + rng() % 37;
+            int n = 1 + rng() % 70;
+            int k = 1 + rng() % 300;
+            int ldc = n + 3;
+            bool negate = trial % 2 == 1;
+            vector<T> a = randomVector((size_t)m * k);
+            vector<T> b = randomVector((size_t)k * n);
+            vector<T> expected = randomVector((size_t)m * ldc);
+            vector<T> actual = expected;
+            gemm::multiplyWith(ref, m, n, k, a.data(), k, b.data(), n, expected.data(), ldc, negate);
+            gemm::multiplyWith(set, m, n, k, a.data(), k, b.data(), n, actual.data(), ldc, negate);
+            ok = ok && matches(expected, actual, 4.0 * k * numeric_limits<T>::epsilon() * k);
+        }
+
+        cout << left << setw(14) << label << setw(10) << set.name << (ok ? "PASS" : "FAIL") << endl;
+        allPassed = allPassed && ok;
+    }
+    return allPassed;
+}
+
+bool runSimdSelfTest() {
+    bool ok = selfTestType<int32_t, int64_t>("int32");
+    ok = selfTestType<int64_t, int64_t>("int64") && ok;
+    ok = selfTestType<float, float>("float") && ok;
+    ok = selfTestType<float, double>("float/double") && ok;
+    ok = selfTestType<double, double>("double") && ok;
+    return ok;
+}
+
+// Measures how multiply and add scale from 1 thread up to the configured count
+void runScalingBenchmark(int maxThreads) {
+    const int n = 2048;
+    cout << "=== Thread Scaling Benchmark (" << n << "x" << n << ") ===" << endl;
+    cout << left << setw(10) << "Threads" << setw(14) << "Mul (ms)" << setw(12) << "Speedup"
+         << setw(14) << "Add (ms)" << "Speedup" << endl;
+
+    Matrix a(n, n), b(n, n);
+    a.randomize();
+    b.randomize();
+
+    auto timeIt = [](const function<void()>& fn, int reps) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < reps; i++) fn();
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        return elapsed.count() / reps;
+    };
+
+    int saved = gemm::strassenCrossover; // scale the blocked kernel only
+    gemm::strassenCrossover = 0;
+    double baseMul = 0, baseAdd = 0;
+    for (int t = 1; t <= maxThreads; t = (t * 2 > maxThreads && t != maxThreads) ? maxThreads : t * 2) {
+        parallel::setThreadCount(t);
+        double mul = timeIt([&] { Matrix c = a * b; }, 2);
+        double add = timeIt([&] { Matrix c = a + b; }, 20);
+        if (t == 1) { baseMul = mul; baseAdd = add; }
+        cout << left << setw(10) << t << setw(14) << fixed << setprecision(2) << mul
+             << setw(12) << baseMul / mul << setw(14) << add << baseAdd / add << endl;
+    }
+    parallel::setThreadCount(maxThreads);
+    gemm::strassenCrossover = saved;
+}
+
+
+int main(int argc, char* argv[]) {
+    // Command-line modes:
+    //   --threads N      worker threads for large operations (default: all cores)
+    //   --bench          single-run GEMM throughput for sizes 64..4096
+    //   --dtype NAME     element type for --bench / --make-file: int32 (default), int64, float or double
+    //   --bench-threads  multiply/add scaling from 1 to N threads
+    //   --isa NAME       force a kernel set: scalar, sse4.2, avx2 or avx512
+    //   --selftest       check every supported SIMD kernel against scalar
+    //   --bench-sparse   CSR memory, SpMV and SpGEMM cost at growing sizes
+    //   --strassen N     Strassen-Winograd above N x N (default 0 = off)
+    //   --bench-strassen time one Strassen level against blocked to find N
+    //   --alloc-report   count Matrix allocations for typical expressions
+    //   --bench-small    2x2..8x8 multiplies/s, FixedMatrix vs Matrix
+    //   --file OP A B OUT  non-interactive add|sub|mul on binary matrix files (type from A's header)
+    //   --make-file R C PATH  write a random R x C binary matrix file
+    string mode;
+    vector<string> modeArgs;
+    uint32_t dtype = DTYPE_INT32;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            parallel::setThreadCount(atoi(argv[++i]));
+        } else if (arg == "--strassen" && i + 1 < argc) {
+            gemm::strassenCrossover = max(0, atoi(argv[++i]));
+        } else if (arg == "--file" && i + 4 < argc) {
+            mode = arg;
+            modeArgs.assign(argv + i + 1, argv + i + 5);
+            i += 4;
+        } else if (arg == "--make-file" && i + 3 < argc) {
+            mode = arg;
+            modeArgs.assign(argv + i + 1, argv + i + 4);
+            i += 3;
+        } else if (arg == "--dtype" && i + 1 < argc) {
+            dtype = dtypeFromName(argv[++i]);
+            if (dtype == 0) {
+                cout << "Error: Unknown element type '" << argv[i] << "' (use int32, int64, float or double)." << endl;
+                return 1;
+            }
+        } else if (arg == "--isa" && i + 1 < argc) {
+            if (!simd::select(argv[++i])) {
+                cout << "Error: Instruction set '" << argv[i] << "' is not supported on this CPU." << endl;
+                return 1;
+            }
+        } else {
+            mode = arg;
+        }
+    }
+    if (mode == "--file") {
+        return matfile::run(modeArgs[0], modeArgs[1], modeArgs[2], modeArgs[3]);
+    }
+    if (mode == "--make-file") {
+        int status = 1;
+        withElementType(dtype, [&](auto tag) {
+            status = matfile::makeRandom<decltype(tag)>(atoi(modeArgs[0].c_str()), atoi(modeArgs[1].c_str()), modeArgs[2]);
+        });
+        return status;
+    }
+    if (mode == "--bench-small") {
+        runSmallMatrixBenchmark();
+        return 0;
+    }
+    if (mode == "--alloc-report") {
+        runAllocationReport();
+        return 0;
+    }
+    if (mode == "--selftest") {
+        return runSimdSelfTest() ? 0 : 1;
+    }
+    if (mode == "--bench") {
+        withElementType(dtype, [](auto tag) { runGemmBenchmark<decltype(tag)>(); });
+        return 0;
+    }
+    if (mode == "--bench-strassen") {
+        runStrassenBenchmark();
+        return 0;
+    }
+    if (mode == "--bench-sparse") {
+        runSparseBenchmark();
+        return 0;
+    }
+    if (mode == "--bench-threads") {
+        runScalingBenchmark(parallel::threadCount);
+        return 0;
+    }
+
     int r1, c1, r2, c2;
     int choice;
 
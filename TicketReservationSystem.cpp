@@ -4,91 +4,767 @@
 #include <iomanip>
 #include <limits>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <latch>     // Start gate for the flash-sale test
+#include <deque>
+#include <optional>
+#include <chrono>
+#include <random>
+#include <cstdlib>   // For atoi
+#include <cstdint>
+#include <cstring>   // For memcpy
+#include <climits>   // For INT_MAX
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <future>
+#include <memory>    // For unique_ptr
 
 using namespace std;
 
+// === Struct: SeatBlock ===
+// A run of adjacent seats in one row; rows and seats are numbered from 0
+struct SeatBlock {
+    int row = 0;
+    int firstSeat = 0;
+    int count = 0;
+};
+
+// Seats in a booking: one block when the group sits together, several
+// when it had to be split up
+inline int seatCount(const vector<SeatBlock>& seats) {
+    int count = 0;
+    for (const SeatBlock& block : seats) count += block.count;
+    return count;
+}
+
+// === Class: SeatMap ===
+// Seats laid out in rows, one bit per seat (1 = free) packed into 64-bit
+// words per row. A free-seat count per row lets the search skip rows that
+// can't fit a group, eight rows per compare; within a row, free runs are
+// found a word at a time with count-trailing-zeros rather than seat by
+// seat. Bits past the end of a row stay 0, so runs never reach the padding.
+// Not thread-safe: Event guards its map with a lock.
+class SeatMap {
+private:
+    typedef int32_t RowCounts __attribute__((vector_size(32))); // 8 rows at a time
+
+    int totalSeats;
+    int seatsPerRow;
+    int rowCount;
+    int wordsPerRow;
+    vector<uint64_t> bits;     // rowCount * wordsPerRow words
+    vector<int32_t> freeInRow; // padded with zeros to a multiple of 8 rows
+    int firstOpenRow = 0;      // every row before this one is full
+
+    // First free seat at or after pos, or len if there is none
+    int nextFree(const uint64_t* row, int pos, int len) const {
+        if (pos >= len) return len;
+        int i = pos >> 6;
+        uint64_t word = row[i] & (~0ull << (pos & 63));
+        while (word == 0) {
+            if (++i == wordsPerRow) return len;
+            word = row[i];
+        }
+        return i * 64 + __builtin_ctzll(word);
+    }
+
+    // First taken seat at or after pos, or len; padding counts as taken
+    int nextTaken(const uint64_t* row, int pos, int len) const {
+        int i = pos >> 6;
+        uint64_t word = ~row[i] & (~0ull << (pos & 63));
+        while (word == 0) {
+            if (++i == wordsPerRow) return len;
+            word = ~row[i];
+        }
+        return min(i * 64 + __builtin_ctzll(word), len);
+    }
+
+    // First row at or after `from` with at least `count` free seats
+    int nextCandidateRow(int from, int count) const {
+        for (; from < rowCount && from % 8 != 0; from++) {
+            if (freeInRow[from] >= count) return from;
+        }
+        RowCounts need = RowCounts{} + count;
+        for (; from < rowCount; from += 8) {
+            RowCounts counts;
+            memcpy(&counts, &freeInRow[from], sizeof counts);
+            RowCounts hit = counts >= need;
+            uint64_t lanes[4];
+            memcpy(lanes, &hit, sizeof lanes);
+            if ((lanes[0] | lanes[1] | lanes[2] | lanes[3]) == 0) continue;
+            for (int r = from; ; r++) {
+                if (freeInRow[r] >= count) return r;
+            }
+        }
+        return rowCount;
+    }
+
+    // Start of the free run of `count` seats in the row nearest its centre
+    // (leftmost on a tie), or -1 if no run is long enough
+    int bestInRow(int row, int count) const {
+        const uint64_t* words = &bits[(size_t)row * wordsPerRow];
+        int len = rowLength(row);
+        int best = -1, bestDistance = INT_MAX;
+        int start = nextFree(words, 0, len);
+        while (start < len) {
+            int end = nextTaken(words, start, len);
+            if (end - start >= count) {
+                int seat = clamp((len - count) / 2, start, end - count);
+                int distance = abs(2 * seat + count - len); // in half-seats
+                if (distance < bestDistance) {
+                    best = seat;
+                    bestDistance = distance;
+                }
+            }
+            start = nextFree(words, end, len);
+        }
+        return best;
+    }
+
+    void mark(const SeatBlock& block, bool free) {
+        uint64_t* words = &bits[(size_t)block.row * wordsPerRow];
+        int pos = block.firstSeat, end = block.firstSeat + block.count;
+        while (pos < end) {
+            int i = pos >> 6, lo = pos & 63;
+            int hi = min(64, lo + (end - pos));
+            uint64_t mask = (hi == 64 ? ~0ull : (1ull << hi) - 1) & (~0ull << lo);
+            if (free) words[i] |= mask;
+            else words[i] &= ~mask;
+            pos = i * 64 + hi;
+        }
+        freeInRow[block.row] += free ? block.count : -block.count;
+    }
+
+public:
+    // The last row holds whatever is left over if the seats don't divide
+    // evenly. No seats makes an empty map with no rows; rows always hold at
+    // least one seat.
+    SeatMap(int seats, int rowSeats)
+        : totalSeats(max(seats, 0)), seatsPerRow(max(rowSeats, 1)),
+          rowCount((totalSeats + seatsPerRow - 1) / seatsPerRow),
+          wordsPerRow((seatsPerRow + 63) / 64),
+          bits((size_t)rowCount * wordsPerRow, 0),
+          freeInRow((rowCount + 7) / 8 * 8, 0) {
+        for (int row = 0; row < rowCount; row++) mark({row, 0, rowLength(row)}, true);
+    }
+
+    int rows() const { return rowCount; }
+    int getSeatsPerRow() const { return seatsPerRow; }
+    int rowLength(int row) const {
+        return row == rowCount - 1 ? totalSeats - row * seatsPerRow : seatsPerRow;
+    }
+
+    bool isFree(int row, int seat) const {
+        return bits[(size_t)row * wordsPerRow + seat / 64] >> (seat % 64) & 1;
+    }
+
+    // Best available block of `count` adjacent seats, marked taken: the
+    // front-most row that can seat the group together, as near its centre
+    // as possible
+    optional<SeatBlock> takeBestAvailable(int count) {
+        if (count <= 0 || count > seatsPerRow) return nullopt;
+        while (firstOpenRow < rowCount && freeInRow[firstOpenRow] == 0) firstOpenRow++;
+        for (int row = nextCandidateRow(firstOpenRow, count); row < rowCount; row = nextCandidateRow(row + 1, count)) {
+            int seat = bestInRow(row, count);
+            if (seat >= 0) {
+                SeatBlock block{row, seat, count};
+                mark(block, false);
+                return block;
+            }
+        }
+        return nullopt;
+    }
+
+    // Seats for a group that can't sit together: free runs taken front to
+    // back and left to right, so the group fills as few rows as it can.
+    // Empty, with nothing taken, if fewer than `count` seats are free.
+    vector<SeatBlock> takeScattered(int count) {
+        vector<SeatBlock> taken;
+        if (count <= 0) return taken;
+        while (firstOpenRow < rowCount && freeInRow[firstOpenRow] == 0) firstOpenRow++;
+        int needed = count;
+        for (int row = nextCandidateRow(firstOpenRow, 1); needed > 0 && row < rowCount; row = nextCandidateRow(row + 1, 1)) {
+            const uint64_t* words = &bits[(size_t)row * wordsPerRow];
+            int len = rowLength(row);
+            for (int start = nextFree(words, 0, len); needed > 0 && start < len; start = nextFree(words, start, len)) {
+                int end = min(nextTaken(words, start, len), start + needed);
+                taken.push_back({row, start, end - start});
+                needed -= end - start;
+                start = end;
+            }
+        }
+        if (needed > 0) {
+            taken.clear();
+            return taken;
+        }
+        for (const SeatBlock& block : taken) mark(block, false);
+        return taken;
+    }
+
+    // A group's seats, marked taken: together if there is room (see
+    // takeBestAvailable), otherwise split up (see takeScattered)
+    vector<SeatBlock> take(int count) {
+        if (optional<SeatBlock> block = takeBestAvailable(count)) return {*block};
+        return takeScattered(count);
+    }
+
+    void release(const SeatBlock& block) {
+        mark(block, true);
+        firstOpenRow = min(firstOpenRow, block.row);
+    }
+
+    // Recounts every row's free seats from the bits; true if the cached
+    // counts agree
+    bool consistent() const {
+        for (int row = 0; row < rowCount; row++) {
+            int free = 0;
+            for (int i = 0; i < wordsPerRow; i++) {
+                free += __builtin_popcountll(bits[(size_t)row * wordsPerRow + i]);
+            }
+            if (free != freeInRow[row]) return false;
+        }
+        return true;
+    }
+};
+
 // === Class: Event ===
-// Represents a movie, flight, or concert
+// Represents a movie, flight, or concert. The seat counter admits or turns
+// away a booking without locking; only a booking that got past it takes
+// seatLock to pick its seats from the map.
 class Event {
 private:
     int id;
     string name;
     string date; // Format: YYYY-MM-DD
     int totalSeats;
-    int availableSeats;
+    atomic<int> availableSeats; // claimed and released by compare-and-swap
     double pricePerSeat;
+    SeatMap seatMap;
+    mutex seatLock;
+
+    // Give back seats that were claimed from the counter
+    void releaseCount(int count) {
+        int available = availableSeats.load(memory_order_relaxed);
+        while (!availableSeats.compare_exchange_weak(available, min(available + count, totalSeats),
+                                                     memory_order_acq_rel, memory_order_relaxed)) {
+        }
+    }
 
 public:
-    Event(int id, string n, string d, int total, double price)
-        : id(id), name(n), date(d), totalSeats(total), availableSeats(total), pricePerSeat(price) {}
+    Event(int id, string n, string d, int total, double price, int seatsPerRow = 10)
+        : id(id), name(n), date(d), totalSeats(total), availableSeats(total), pricePerSeat(price),
+          seatMap(total, min(seatsPerRow, total)) {}
 
     int getId() const { return id; }
     string getName() const { return name; }
-    int getAvailableSeats() const { return availableSeats; }
+    int getTotalSeats() const { return totalSeats; }
+    int getAvailableSeats() const { return availableSeats.load(); }
     double getPrice() const { return pricePerSeat; }
 
-    bool bookSeats(int count) {
-        if (count > 0 && count <= availableSeats) {
-            availableSeats -= count;
-            return true;
+    // Books `count` seats: the best available block if the group fits
+    // together, otherwise the front-most free seats split over as few rows
+    // as possible; empty if there aren't enough left. Safe for any number
+    // of buyers at once: the check and the decrement of the seat counter
+    // are one compare-and-swap, retried if another booking got in between,
+    // so the event can never be oversold, and a sold-out event turns
+    // buyers away without locking.
+    vector<SeatBlock> bookSeats(int count) {
+        if (count <= 0) return {};
+        int available = availableSeats.load(memory_order_relaxed);
+        do {
+            if (count > available) return {};
+        } while (!availableSeats.compare_exchange_weak(available, available - count,
+                                                       memory_order_acq_rel, memory_order_relaxed));
+        vector<SeatBlock> seats;
+        {
+            lock_guard<mutex> lock(seatLock);
+            seats = seatMap.take(count);
+        }
+        if (seats.empty()) releaseCount(count); // the counter guarantees the seats; never expected
+        return seats;
+    }
+
+    void cancelSeats(const vector<SeatBlock>& seats) {
+        int count = seatCount(seats);
+        if (count <= 0) return;
+        {
+            lock_guard<mutex> lock(seatLock);
+            for (const SeatBlock& block : seats) seatMap.release(block);
         }
-        return false;
+        releaseCount(count);
     }
 
-    void cancelSeats(int count) {
-        availableSeats += count;
-        if (availableSeats > totalSeats) availableSeats = totalSeats;
+    bool seatMapConsistent() {
+        lock_guard<mutex> lock(seatLock);
+        return seatMap.consistent();
     }
 
     void display() const {
         cout << left << setw(5) << id 
              << setw(20) << name 
              << setw(12) << date 
-             << setw(10) << availableSeats 
+             << setw(10) << availableSeats.load() 
              << " $" << fixed << setprecision(2) << pricePerSeat << endl;
     }
 };
 
 // === Class: Ticket ===
-// Represents a confirmed booking
+// Represents a confirmed booking. The customer's name is interned: every
+// ticket for the same customer points at one shared copy (see TicketStore).
 class Ticket {
 private:
     int ticketId;
     int eventId;
-    string customerName;
-    int seatsBooked;
+    const string* customerName;
+    vector<SeatBlock> seats;
     double totalCost;
 
 public:
-    Ticket(int tId, int eId, string name, int seats, double cost)
-        : ticketId(tId), eventId(eId), customerName(name), seatsBooked(seats), totalCost(cost) {}
+    Ticket(int tId, int eId, const string* name, vector<SeatBlock> seats, double cost)
+        : ticketId(tId), eventId(eId), customerName(name), seats(move(seats)), totalCost(cost) {}
 
     int getTicketId() const { return ticketId; }
     int getEventId() const { return eventId; }
-    int getSeatsBooked() const { return seatsBooked; }
+    const string& getCustomerName() const { return *customerName; }
+    int getSeatsBooked() const { return seatCount(seats); }
+    const vector<SeatBlock>& getSeats() const { return seats; }
 
     void display() const {
         cout << "Ticket #" << ticketId << " | Event ID: " << eventId 
-             << " | Name: " << customerName 
-             << " | Seats: " << seatsBooked 
+             << " | Name: " << *customerName 
+             << " | Seats: " << getSeatsBooked() << " (";
+        for (size_t i = 0; i < seats.size(); i++) {
+            if (i > 0) cout << "; ";
+            cout << "Row " << seats[i].row + 1 << ", Seat " << seats[i].firstSeat + 1;
+            if (seats[i].count > 1) cout << "-" << seats[i].firstSeat + seats[i].count;
+        }
+        cout << ")"
              << " | Total: $" << fixed << setprecision(2) << totalCost << endl;
     }
 };
 
+// === Class: SlotMap ===
+// Values in a vector of slots, reached through handles that stay valid
+// while the value lives: insert, lookup and erase are O(1) and never move
+// other values. Each slot carries a generation that is bumped when its
+// value is erased, so a handle to an erased value is recognised as stale
+// rather than finding whatever reused the slot. Freed slots are chained
+// into a free list and reused before the vector grows.
+struct SlotHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+};
+
+template <class T>
+class SlotMap {
+private:
+    static const uint32_t NONE = UINT32_MAX;
+
+    struct Slot {
+        optional<T> value;
+        uint32_t generation = 0;
+        uint32_t nextFree = NONE;
+    };
+
+    vector<Slot> slots;
+    uint32_t freeHead = NONE;
+    size_t live = 0;
+
+public:
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (freeHead != NONE) {
+            index = freeHead;
+            freeHead = slots[index].nextFree;
+        } else {
+            index = slots.size();
+            slots.emplace_back();
+        }
+        slots[index].value.emplace(move(value));
+        live++;
+        return SlotHandle{index, slots[index].generation};
+    }
+
+    // The value, or nullptr if the handle is stale
+    T* get(SlotHandle handle) {
+        if (handle.index >= slots.size()) return nullptr;
+        Slot& slot = slots[handle.index];
+        return slot.generation == handle.generation && slot.value ? &*slot.value : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const { return const_cast<SlotMap*>(this)->get(handle); }
+
+    // Removes and returns the value, or nothing if the handle is stale
+    optional<T> erase(SlotHandle handle) {
+        T* value = get(handle);
+        if (value == nullptr) return nullopt;
+        optional<T> removed(move(*value));
+        Slot& slot = slots[handle.index];
+        slot.value.reset();
+        slot.generation++;
+        slot.nextFree = freeHead;
+        freeHead = handle.index;
+        live--;
+        return removed;
+    }
+
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+
+    // Visits live values in slot order
+    template <class F>
+    void forEach(F&& fn) const {
+        for (const auto& slot : slots) {
+            if (slot.value) fn(*slot.value);
+        }
+    }
+};
+
+// === Class: TicketStore ===
+// Live tickets in a slot map, with a hash index from ticket number to
+// handle, so finding or cancelling a ticket costs the same with a million
+// tickets as with ten. Each customer's tickets are also chained through
+// their entries in booking order, with the ends kept per customer:
+// cancelling unlinks a ticket in O(1) however many the customer holds, and
+// listing them walks only that customer's tickets, already in order.
+// Customer names are interned here once and never freed, which keeps
+// Ticket pointers valid.
+class TicketStore {
+private:
+    static constexpr SlotHandle NONE{UINT32_MAX, 0}; // end of a chain; never a live slot
+
+    struct Entry {
+        Ticket ticket;
+        SlotHandle previous, next; // the customer's tickets booked before and after
+    };
+
+    struct CustomerTickets {
+        SlotHandle first = NONE, last = NONE;
+    };
+
+    SlotMap<Entry> tickets;
+    unordered_map<int, SlotHandle> byId;
+    unordered_set<string> names;
+    unordered_map<const string*, CustomerTickets> byCustomer;
+
+public:
+    // The shared copy of a customer's name
+    const string* intern(const string& name) { return &*names.insert(name).first; }
+
+    // Records a ticket; its handle, for lookups that skip the id index
+    SlotHandle add(int ticketId, int eventId, const string& customer, vector<SeatBlock> seats, double cost) {
+        const string* name = intern(customer);
+        CustomerTickets& owned = byCustomer[name];
+        SlotHandle handle = tickets.insert(Entry{Ticket(ticketId, eventId, name, move(seats), cost),
+                                                 owned.last, NONE});
+        if (Entry* last = tickets.get(owned.last)) last->next = handle;
+        else owned.first = handle;
+        owned.last = handle;
+        byId[ticketId] = handle;
+        return handle;
+    }
+
+    const Ticket* find(int ticketId) const {
+        auto it = byId.find(ticketId);
+        return it == byId.end() ? nullptr : get(it->second);
+    }
+
+    // The ticket, or nullptr once it has been cancelled
+    const Ticket* get(SlotHandle handle) const {
+        const Entry* entry = tickets.get(handle);
+        return entry ? &entry->ticket : nullptr;
+    }
+
+    // Removes and returns the ticket, or nothing if there is no such ticket
+    optional<Ticket> remove(int ticketId) {
+        auto it = byId.find(ticketId);
+        if (it == byId.end()) return nullopt;
+        SlotHandle handle = it->second;
+        byId.erase(it);
+
+        Entry* entry = tickets.get(handle);
+        auto owned = byCustomer.find(&entry->ticket.getCustomerName());
+        if (Entry* previous = tickets.get(entry->previous)) previous->next = entry->next;
+        else owned->second.first = entry->next;
+        if (Entry* next = tickets.get(entry->next)) next->previous = entry->previous;
+        else owned->second.last = entry->previous;
+        if (owned->second.first.index == NONE.index) byCustomer.erase(owned);
+
+        return tickets.erase(handle)->ticket;
+    }
+
+    // A customer's tickets in booking order; the cost is in their own
+    // ticket count, not the store's
+    vector<const Ticket*> ticketsFor(const string& customer) const {
+        vector<const Ticket*> found;
+        auto name = names.find(customer);
+        if (name == names.end()) return found;
+        auto owned = byCustomer.find(&*name);
+        if (owned == byCustomer.end()) return found;
+        for (const Entry* entry = tickets.get(owned->second.first); entry; entry = tickets.get(entry->next)) {
+            found.push_back(&entry->ticket);
+        }
+        return found;
+    }
+
+    size_t size() const { return tickets.size(); }
+    bool empty() const { return tickets.empty(); }
+
+    template <class F>
+    void forEach(F&& fn) const {
+        tickets.forEach([&](const Entry& entry) { fn(entry.ticket); });
+    }
+};
+
+// === Class: TimerWheel ===
+// Hierarchical timing wheel: four levels of 64 slots, one tick per slot at
+// level 0, 64 ticks at level 1 and so on, covering 2^24 ticks (4.6 hours
+// of millisecond ticks). A timer goes in the lowest level whose slot
+// width reaches its deadline from the current tick, so scheduling is O(1)
+// however many timers are pending. When a level's slot comes round, its
+// timers cascade down a level, and each timer is moved at most once per
+// level before it fires. Deadlines beyond the wheel wait in the top
+// level's first slot, which next comes round when the top level wraps,
+// and are re-placed from there. There is no
+// cancel: owners ignore timers for things that are already gone.
+template <class T>
+class TimerWheel {
+private:
+    static const int BITS = 6, SLOTS = 1 << BITS, LEVELS = 4;
+
+    struct Timer {
+        uint64_t deadline;
+        T item;
+    };
+
+    vector<Timer> slots[LEVELS][SLOTS];
+    uint64_t now;
+    size_t pending = 0;
+
+    // Slot for a timer due no earlier than `earliest`: the lowest level on
+    // which its deadline and now agree in every higher digit
+    void place(const Timer& timer, uint64_t earliest) {
+        uint64_t at = max(timer.deadline, earliest);
+        for (int level = 0; level < LEVELS; level++) {
+            if (((at ^ now) >> (BITS * (level + 1))) == 0) {
+                slots[level][(at >> (BITS * level)) & (SLOTS - 1)].push_back(timer);
+                return;
+            }
+        }
+        slots[LEVELS - 1][0].push_back(timer); // cascades when the top level wraps
+    }
+
+public:
+    explicit TimerWheel(uint64_t start) : now(start) {}
+
+    uint64_t current() const { return now; }
+    size_t size() const { return pending; }
+
+    // A deadline already passed fires on the next tick
+    void schedule(uint64_t deadline, T item) {
+        place(Timer{deadline, move(item)}, now + 1);
+        pending++;
+    }
+
+    // Moves the wheel on to tick `to`, calling fire(item) for every timer
+    // due by then
+    template <class F>
+    void advance(uint64_t to, F&& fire) {
+        while (now < to) {
+            if (pending == 0) {
+                now = to;
+                return;
+            }
+            now++;
+            // Cascade each level whose lower digits just rolled over, top
+            // down, so timers can fall through several levels in one tick
+            int top = 0;
+            while (top + 1 < LEVELS && (now & ((1ull << (BITS * (top + 1))) - 1)) == 0) top++;
+            for (int level = top; level >= 1; level--) {
+                vector<Timer> due;
+                due.swap(slots[level][(now >> (BITS * level)) & (SLOTS - 1)]);
+                for (const Timer& timer : due) place(timer, now);
+            }
+            vector<Timer> due;
+            due.swap(slots[0][now & (SLOTS - 1)]);
+            pending -= due.size();
+            for (Timer& timer : due) fire(timer.item);
+        }
+    }
+};
+
+// Milliseconds on the steady clock, the tick used for seat holds
+uint64_t steadyMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// === Struct: SeatHold ===
+// Seats set aside for a customer while they pay; released if not
+// confirmed by expiresAt (a steadyMillis() time)
+struct SeatHold {
+    int eventId;
+    vector<SeatBlock> seats;
+    uint64_t expiresAt;
+};
+
 // === Class: ReservationSystem ===
-// Manages events and bookings
+// Manages events and bookings. Seats are claimed lock-free on the event;
+// only a successful booking takes bookingsLock to record its ticket, so
+// buyers turned away during a sell-out never wait on each other.
+//
+// Seats can also be held for a while before they are paid for. Holds live
+// in a slot map and each gets one timer on a shared TimerWheel. Confirming
+// or releasing a hold erases it, which leaves its timer to find a stale
+// handle and do nothing. Expiry runs whenever expireHolds() is called,
+// normally from the one reaper thread started by startHoldReaper(). The
+// hold calls take the time as a parameter so tests can drive the clock.
 class ReservationSystem {
 private:
-    vector<Event> events;
-    vector<Ticket> bookings;
-    int nextTicketId = 1001;
+    deque<Event> events; // never moved once added, so Event* stays valid
+    TicketStore bookings;
+    mutex bookingsLock;
+    atomic<int> nextTicketId{1001};
+
+    SlotMap<SeatHold> holds;
+    TimerWheel<SlotHandle> holdTimers{steadyMillis()};
+    mutex holdsLock;
+    thread holdReaper;
+    atomic<bool> stopReaper{false};
 
 public:
     ReservationSystem() {
         // Initialize with some dummy data
-        events.push_back(Event(1, "Avengers Movie", "2023-12-01", 50, 12.50));
-        events.push_back(Event(2, "Rock Concert", "2023-12-05", 100, 45.00));
-        events.push_back(Event(3, "Flight NY-LDN", "2023-12-10", 20, 450.00));
+        events.emplace_back(1, "Avengers Movie", "2023-12-01", 50, 12.50);
+        events.emplace_back(2, "Rock Concert", "2023-12-05", 100, 45.00);
+        events.emplace_back(3, "Flight NY-LDN", "2023-12-10", 20, 450.00, 4);
+    }
+
+    ~ReservationSystem() {
+        stopReaper = true;
+        if (holdReaper.joinable()) holdReaper.join();
+    }
+
+    // Not thread-safe: add events before booking starts
+    void addEvent(int id, const string& name, const string& date, int seats, double price,
+                  int seatsPerRow = 10) {
+        events.emplace_back(id, name, date, seats, price, seatsPerRow);
+    }
+
+    // Thread-safe booking; the new ticket's handle (see getTicket), or
+    // nothing if the event doesn't exist or hasn't enough seats left
+    optional<SlotHandle> tryBook(int eventId, const string& customerName, int numSeats) {
+        Event* event = findEvent(eventId);
+        if (event == nullptr) return nullopt;
+        vector<SeatBlock> seats = event->bookSeats(numSeats);
+        if (seats.empty()) return nullopt;
+        lock_guard<mutex> lock(bookingsLock);
+        return bookings.add(nextTicketId++, eventId, customerName, move(seats), numSeats * event->getPrice());
+    }
+
+    // Holds the best available `numSeats` seats (as for a booking) for
+    // ttlMs; the hold's handle, or nothing if the seats can't be had
+    optional<SlotHandle> holdSeats(int eventId, int numSeats, uint64_t ttlMs, uint64_t nowMs = steadyMillis()) {
+        Event* event = findEvent(eventId);
+        if (event == nullptr) return nullopt;
+        vector<SeatBlock> seats = event->bookSeats(numSeats);
+        if (seats.empty()) return nullopt;
+        lock_guard<mutex> lock(holdsLock);
+        SlotHandle hold = holds.insert(SeatHold{eventId, move(seats), nowMs + ttlMs});
+        holdTimers.schedule(nowMs + ttlMs, hold);
+        return hold;
+    }
+
+    // Books the held seats; the ticket's handle, or nothing if the hold has
+    // expired (even if not yet reaped), was released, or was already
+    // confirmed
+    optional<SlotHandle> confirmHold(SlotHandle hold, const string& customerName, uint64_t nowMs = steadyMillis()) {
+        optional<SeatHold> held;
+        {
+            lock_guard<mutex> lock(holdsLock);
+            SeatHold* live = holds.get(hold);
+            if (live == nullptr || nowMs >= live->expiresAt) return nullopt;
+            held = holds.erase(hold);
+        }
+        Event* event = findEvent(held->eventId);
+        lock_guard<mutex> lock(bookingsLock);
+        double cost = seatCount(held->seats) * event->getPrice();
+        return bookings.add(nextTicketId++, held->eventId, customerName, move(held->seats), cost);
+    }
+
+    // A copy of the ticket behind a booking handle, or nothing once it
+    // has been cancelled
+    optional<Ticket> getTicket(SlotHandle ticket) {
+        lock_guard<mutex> lock(bookingsLock);
+        const Ticket* found = bookings.get(ticket);
+        return found ? optional<Ticket>(*found) : nullopt;
+    }
+
+    // Gives held seats back early; false if the hold is already gone
+    bool releaseHold(SlotHandle hold) {
+        optional<SeatHold> held;
+        {
+            lock_guard<mutex> lock(holdsLock);
+            held = holds.erase(hold);
+        }
+        if (!held) return false;
+        findEvent(held->eventId)->cancelSeats(held->seats);
+        return true;
+    }
+
+    // Releases every hold due by nowMs; the number released
+    size_t expireHolds(uint64_t nowMs = steadyMillis()) {
+        vector<SeatHold> expired;
+        {
+            lock_guard<mutex> lock(holdsLock);
+            holdTimers.advance(nowMs, [&](SlotHandle hold) {
+                if (optional<SeatHold> held = holds.erase(hold)) expired.push_back(*held);
+            });
+        }
+        for (const SeatHold& held : expired) findEvent(held.eventId)->cancelSeats(held.seats);
+        return expired.size();
+    }
+
+    // Starts the thread that expires holds every intervalMs; it stops when
+    // the system is destroyed
+    void startHoldReaper(int intervalMs = 10) {
+        if (holdReaper.joinable()) return;
+        holdReaper = thread([this, intervalMs] {
+            while (!stopReaper.load()) {
+                this_thread::sleep_for(chrono::milliseconds(intervalMs));
+                expireHolds();
+            }
+        });
+    }
+
+    size_t activeHolds() {
+        lock_guard<mutex> lock(holdsLock);
+        return holds.size();
+    }
+
+    // Seats still available, or 0 for an unknown event
+    int getAvailableSeats(int eventId) {
+        Event* event = findEvent(eventId);
+        return event ? event->getAvailableSeats() : 0;
+    }
+
+    // True if the event's seat map agrees with its free-seat counts, which
+    // a seat handed out twice would break
+    bool seatMapConsistent(int eventId) {
+        Event* event = findEvent(eventId);
+        return event != nullptr && event->seatMapConsistent();
+    }
+
+    // Seats sold across all recorded tickets for an event
+    int seatsSold(int eventId) {
+        lock_guard<mutex> lock(bookingsLock);
+        int sold = 0;
+        bookings.forEach([&](const Ticket& ticket) {
+            if (ticket.getEventId() == eventId) sold += ticket.getSeatsBooked();
+        });
+        return sold;
     }
 
     void displayEvents() const {
@@ -107,56 +783,39 @@ public:
 
     void bookTicket(int eventId, string customerName, int numSeats) {
         Event* event = findEvent(eventId);
-        
         if (event == nullptr) {
             cout << "Error: Event ID not found." << endl;
             return;
         }
 
-        if (event->bookSeats(numSeats)) {
-            double totalCost = numSeats * event->getPrice();
-            Ticket newTicket(nextTicketId++, eventId, customerName, numSeats, totalCost);
-            bookings.push_back(newTicket);
-            
+        if (optional<SlotHandle> booked = tryBook(eventId, customerName, numSeats)) {
             cout << "\nBooking Successful!" << endl;
-            newTicket.display();
+            if (optional<Ticket> newTicket = getTicket(*booked)) newTicket->display();
         } else {
             cout << "Error: Not enough seats available." << endl;
         }
     }
 
     void cancelTicket(int ticketId) {
-        auto it = find_if(bookings.begin(), bookings.end(), 
-            [ticketId](const Ticket& t) { return t.getTicketId() == ticketId; });
-
-        if (it != bookings.end()) {
+        lock_guard<mutex> lock(bookingsLock);
+        if (optional<Ticket> ticket = bookings.remove(ticketId)) {
             // Restore seats to the event
-            Event* event = findEvent(it->getEventId());
+            Event* event = findEvent(ticket->getEventId());
             if (event) {
-                event->cancelSeats(it->getSeatsBooked());
+                event->cancelSeats(ticket->getSeats());
             }
 
-            // Remove ticket
             cout << "Ticket #" << ticketId << " cancelled successfully. Refund processed." << endl;
-            bookings.erase(it);
         } else {
             cout << "Error: Ticket ID not found." << endl;
         }
     }
 
     void displayMyTickets(string name) const {
-        bool found = false;
         cout << "\n--- Tickets for " << name << " ---" << endl;
-        for (const auto& ticket : bookings) {
-            // In a real app, we'd use ID or stricter comparison
-            // Here we compare strings for simplicity, but it's not robust for production
-            // We can't easily access private name, so let's just show all for demo or add getter
-            // For this demo, I'll iterate and check via friend or hack, 
-            // but let's just make a public getter for display logic
-             ticket.display(); // Showing all for simplicity in this console demo
-             found = true;
-        }
-        if (!found) cout << "No tickets found." << endl;
+        vector<const Ticket*> mine = bookings.ticketsFor(name);
+        for (const Ticket* ticket : mine) ticket->display();
+        if (mine.empty()) cout << "No tickets found." << endl;
     }
 
     void displayAllBookings() const {
@@ -164,9 +823,7 @@ public:
         if (bookings.empty()) {
             cout << "No active bookings." << endl;
         } else {
-            for (const auto& ticket : bookings) {
-                ticket.display();
-            }
+            bookings.forEach([](const Ticket& ticket) { ticket.display(); });
         }
     }
 
@@ -179,15 +836,784 @@ private:
     }
 };
 
+// === Sharded Reservation System ===
+// Actor-style partitioning for on-sales with many events at once. Events
+// are hash-sharded across worker threads, and each shard owns its events,
+// seat maps and tickets outright: only its worker ever touches them, so
+// booking and cancelling take no locks at all. Other threads talk to a
+// shard only through its message queue, and a hot event slows down only
+// the shard it lives on. Ticket numbers encode their shard, so a
+// cancellation goes straight to the shard that issued the ticket.
+struct ShardRequest {
+    enum Kind { Book, Cancel };
+    Kind kind;
+    int eventId;   // Book
+    int ticketId;  // Cancel
+    int numSeats;  // Book
+    string customer;
+};
+
+// Book: the new ticket; Cancel: the cancelled ticket. Nothing if refused.
+using BookingCallback = function<void(const optional<Ticket>& ticket)>;
+
+// A shard's mailbox (Vyukov's intrusive MPSC list). Any thread may push
+// through ReservationShard::submit: one exchange claims the tail, then a
+// store links the old tail to the new node, so a burst of buyers on one
+// shard never take a lock. Only the shard's worker pops, and it owns each
+// node from then on: it runs the callback and deletes the node.
+// The queue itself has no way to sleep. The shard pairs it with its
+// `queued` counter: submit bumps the counter after the push and wakes the
+// worker only on the 0 -> 1 step. The worker pops exactly as many nodes as
+// the counter showed, then subtracts that many. A pop that comes back
+// empty inside that count means a producer is between its exchange and
+// its link, so the worker yields and tries again.
+class ShardQueue {
+public:
+    struct Node {
+        atomic<Node*> next{nullptr};
+        ShardRequest request;
+        BookingCallback done;
+    };
+
+private:
+    alignas(64) atomic<Node*> newest;
+    alignas(64) Node* oldest; // consumer only
+    Node stub;
+
+public:
+    ShardQueue() : newest(&stub), oldest(&stub) {}
+
+    void push(Node* node) {
+        node->next.store(nullptr, memory_order_relaxed);
+        Node* previous = newest.exchange(node, memory_order_acq_rel);
+        previous->next.store(node, memory_order_release);
+    }
+
+    // Oldest node, or nullptr if the queue is empty or its oldest node is
+    // still being linked by a producer (the caller just tries again)
+    Node* pop() {
+        Node* node = oldest;
+        Node* next = node->next.load(memory_order_acquire);
+        if (node == &stub) {
+            if (next == nullptr) return nullptr;
+            oldest = next;
+            node = next;
+            next = next->next.load(memory_order_acquire);
+        }
+        if (next != nullptr) {
+            oldest = next;
+            return node;
+        }
+        if (node != newest.load(memory_order_acquire)) return nullptr;
+        push(&stub); // node is the only one left: put the stub behind it
+        next = node->next.load(memory_order_acquire);
+        if (next != nullptr) {
+            oldest = next;
+            return node;
+        }
+        return nullptr;
+    }
+};
+
+class ReservationShard {
+private:
+    struct OwnedEvent {
+        double pricePerSeat;
+        int totalSeats;
+        int availableSeats;
+        SeatMap seatMap;
+    };
+
+    // Worker-only once started
+    unordered_map<int, OwnedEvent> events;
+    TicketStore tickets;
+    int shardIndex, shardCount;
+    int nextLocalTicket = 0;
+    uint64_t booked = 0, refused = 0;
+
+    ShardQueue queue;
+    static const uint64_t STOP = 1ull << 63;
+    atomic<uint64_t> queued{0}; // pushed but not yet taken, plus STOP; the worker sleeps on it
+    thread worker;
+
+    optional<Ticket> book(const ShardRequest& r) {
+        auto it = events.find(r.eventId);
+        if (it == events.end() || r.numSeats > it->second.availableSeats) return nullopt;
+        OwnedEvent& event = it->second;
+        vector<SeatBlock> seats = event.seatMap.take(r.numSeats);
+        if (seats.empty()) return nullopt;
+        event.availableSeats -= r.numSeats;
+        int ticketId = 1001 + nextLocalTicket++ * shardCount + shardIndex;
+        return *tickets.get(tickets.add(ticketId, r.eventId, r.customer, move(seats), r.numSeats * event.pricePerSeat));
+    }
+
+    optional<Ticket> cancel(const ShardRequest& r) {
+        optional<Ticket> ticket = tickets.remove(r.ticketId);
+        if (ticket) {
+            OwnedEvent& event = events.at(ticket->getEventId());
+            for (const SeatBlock& block : ticket->getSeats()) event.seatMap.release(block);
+            event.availableSeats += ticket->getSeatsBooked();
+        }
+        return ticket;
+    }
+
+    void run() {
+        while (true) {
+            uint64_t state = queued.load();
+            uint64_t waiting = state & ~STOP;
+            if (waiting == 0) {
+                if (state & STOP) return;
+                queued.wait(state);
+                continue;
+            }
+            for (uint64_t taken = 0; taken < waiting;) {
+                ShardQueue::Node* node = queue.pop();
+                if (node == nullptr) {
+                    this_thread::yield(); // a producer is between its two steps
+                    continue;
+                }
+                optional<Ticket> result = node->request.kind == ShardRequest::Book ? book(node->request)
+                                                                                   : cancel(node->request);
+                if (node->request.kind == ShardRequest::Book) (result ? booked : refused)++;
+                if (node->done) node->done(result);
+                delete node;
+                taken++;
+            }
+            queued.fetch_sub(waiting);
+        }
+    }
+
+public:
+    ReservationShard(int index, int count) : shardIndex(index), shardCount(count) {}
+
+    ReservationShard(const ReservationShard&) = delete;
+    ReservationShard& operator=(const ReservationShard&) = delete;
+
+    ~ReservationShard() { stop(); }
+
+    // Only before start()
+    void addEvent(int id, int seats, double price, int seatsPerRow) {
+        events.try_emplace(id, OwnedEvent{price, seats, seats, SeatMap(seats, min(seatsPerRow, seats))});
+    }
+
+    void start() {
+        if (!worker.joinable()) worker = thread(&ReservationShard::run, this);
+    }
+
+    // Handles everything already submitted, then stops
+    void stop() {
+        if (!worker.joinable()) return;
+        queued.fetch_or(STOP);
+        queued.notify_one();
+        worker.join();
+    }
+
+    // done(result), if given, runs on the shard's worker thread
+    void submit(ShardRequest request, BookingCallback done) {
+        auto* node = new ShardQueue::Node;
+        node->request = move(request);
+        node->done = move(done);
+        queue.push(node);
+        if ((queued.fetch_add(1) & ~STOP) == 0) queued.notify_one();
+    }
+
+    // Only once stopped: bookings made and refused, and whether every
+    // event's seats add up with its tickets
+    uint64_t bookedCount() const { return booked; }
+    uint64_t refusedCount() const { return refused; }
+    bool audit() const {
+        unordered_map<int, int> sold;
+        tickets.forEach([&](const Ticket& t) { sold[t.getEventId()] += t.getSeatsBooked(); });
+        for (const auto& [id, event] : events) {
+            auto it = sold.find(id);
+            int seatsSold = it == sold.end() ? 0 : it->second;
+            if (event.availableSeats + seatsSold != event.totalSeats || !event.seatMap.consistent()) return false;
+        }
+        return true;
+    }
+};
+
+class ShardedReservationSystem {
+private:
+    vector<unique_ptr<ReservationShard>> shards;
+
+    ReservationShard& shardForEvent(int eventId) {
+        uint64_t mixed = (uint64_t)(uint32_t)eventId * 0x9E3779B97F4A7C15ull;
+        return *shards[(mixed >> 32) % shards.size()];
+    }
+
+    ReservationShard& shardForTicket(int ticketId) {
+        return *shards[(uint32_t)(ticketId - 1001) % shards.size()];
+    }
+
+public:
+    explicit ShardedReservationSystem(int shardCount) {
+        for (int i = 0; i < max(shardCount, 1); i++) shards.push_back(make_unique<ReservationShard>(i, max(shardCount, 1)));
+    }
+
+    // Only before start()
+    void addEvent(int id, int seats, double price, int seatsPerRow = 10) {
+        shardForEvent(id).addEvent(id, seats, price, seatsPerRow);
+    }
+
+    void start() {
+        for (auto& shard : shards) shard->start();
+    }
+
+    // Handles everything already submitted, then stops every shard
+    void stop() {
+        for (auto& shard : shards) shard->stop();
+    }
+
+    void book(int eventId, const string& customerName, int numSeats, BookingCallback done) {
+        shardForEvent(eventId).submit(ShardRequest{ShardRequest::Book, eventId, 0, numSeats, customerName}, move(done));
+    }
+
+    future<optional<Ticket>> book(int eventId, const string& customerName, int numSeats) {
+        auto result = make_shared<promise<optional<Ticket>>>();
+        future<optional<Ticket>> ticket = result->get_future();
+        book(eventId, customerName, numSeats, [result](const optional<Ticket>& t) { result->set_value(t); });
+        return ticket;
+    }
+
+    void cancel(int ticketId, BookingCallback done) {
+        shardForTicket(ticketId).submit(ShardRequest{ShardRequest::Cancel, 0, ticketId, 0, ""}, move(done));
+    }
+
+    future<optional<Ticket>> cancel(int ticketId) {
+        auto result = make_shared<promise<optional<Ticket>>>();
+        future<optional<Ticket>> ticket = result->get_future();
+        cancel(ticketId, [result](const optional<Ticket>& t) { result->set_value(t); });
+        return ticket;
+    }
+
+    // Only once stopped
+    uint64_t bookedCount() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards) total += shard->bookedCount();
+        return total;
+    }
+
+    bool audit() const {
+        for (const auto& shard : shards) {
+            if (!shard->audit()) return false;
+        }
+        return true;
+    }
+};
+
+// === Flash Sale Stress Test ===
+// Thousands of buyer threads are released at once onto a single event and
+// keep booking 1-4 seats (never more than appear to be left) until it sells
+// out. Passes if the seats on the recorded tickets add up to exactly the
+// event's capacity, the event shows none left and its seat map is intact:
+// any lost update would oversell, strand or double-book seats.
+bool runFlashSale(int buyers, int capacity) {
+    const int eventId = 100;
+    ReservationSystem system;
+    system.addEvent(eventId, "Flash Sale", "2024-01-01", capacity, 99.00, 50);
+
+    atomic<long long> bookingsMade{0}, attemptsFailed{0};
+    latch startGate(buyers + 1);
+    vector<thread> threads;
+    threads.reserve(buyers);
+    for (int t = 0; t < buyers; t++) {
+        threads.emplace_back([&, t] {
+            minstd_rand rng(t + 1);
+            long long made = 0, failed = 0;
+            startGate.arrive_and_wait();
+            while (true) {
+                int left = system.getAvailableSeats(eventId);
+                if (left == 0) break;
+                int want = min<int>(1 + rng() % 4, left);
+                if (system.tryBook(eventId, "Buyer " + to_string(t), want)) made++;
+                else failed++;
+            }
+            bookingsMade += made;
+            attemptsFailed += failed;
+        });
+    }
+
+    auto start = chrono::steady_clock::now();
+    startGate.arrive_and_wait();
+    for (auto& t : threads) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int sold = system.seatsSold(eventId);
+    int left = system.getAvailableSeats(eventId);
+    bool ok = sold == capacity && left == 0 && system.seatMapConsistent(eventId);
+
+    cout << "=== Flash Sale: " << buyers << " buyers, " << capacity << " seats ===" << endl;
+    cout << fixed << setprecision(3);
+    cout << "Sold out in:        " << seconds << " s" << endl;
+    cout << setprecision(0);
+    cout << "Bookings:           " << bookingsMade.load() << " (" << bookingsMade / seconds << " /s)" << endl;
+    cout << "Failed attempts:    " << attemptsFailed.load() << endl;
+    cout << "Seats sold:         " << sold << " of " << capacity << ", " << left << " left" << endl;
+    cout << (ok ? "PASS" : "FAIL: seat count does not match capacity") << endl;
+    return ok;
+}
+
+// === Seat Map Benchmark ===
+// A 100,000-seat venue (400 rows of 250) is filled to about 90% with
+// groups of 1-8, then put through a churn of bookings and cancellations.
+// The same sequence runs against SeatMap and against a plain seat-by-seat
+// scan with the same best-available rule; every placement must match.
+class NaiveSeatMap {
+private:
+    vector<vector<char>> free;
+
+public:
+    NaiveSeatMap(int rows, int seatsPerRow) : free(rows, vector<char>(seatsPerRow, 1)) {}
+
+    optional<SeatBlock> takeBestAvailable(int count) {
+        for (int row = 0; row < (int)free.size(); row++) {
+            int len = free[row].size();
+            int best = -1, bestDistance = INT_MAX;
+            for (int seat = 0; seat + count <= len; seat++) {
+                bool fits = true;
+                for (int i = 0; i < count && fits; i++) fits = free[row][seat + i];
+                int distance = abs(2 * seat + count - len);
+                if (fits && distance < bestDistance) {
+                    best = seat;
+                    bestDistance = distance;
+                }
+            }
+            if (best >= 0) {
+                fill_n(free[row].begin() + best, count, 0);
+                return SeatBlock{row, best, count};
+            }
+        }
+        return nullopt;
+    }
+
+    void release(const SeatBlock& block) {
+        fill_n(free[block.row].begin() + block.firstSeat, block.count, 1);
+    }
+};
+
+// Fill, then churn; the placements made, in order (row -1 for a refusal)
+template <class Map>
+vector<SeatBlock> runSeatWorkload(Map& map, int seats, int churnOps, double& seconds) {
+    mt19937 rng(2024);
+    vector<SeatBlock> held, placed;
+    int taken = 0;
+    auto start = chrono::steady_clock::now();
+    auto book = [&] {
+        optional<SeatBlock> block = map.takeBestAvailable(1 + rng() % 8);
+        placed.push_back(block ? *block : SeatBlock{-1, 0, 0});
+        if (block) {
+            held.push_back(*block);
+            taken += block->count;
+        }
+    };
+    while (taken < seats * 9 / 10) book();
+    for (int op = 0; op < churnOps; op++) {
+        if (rng() % 2 == 0 || held.empty()) {
+            book();
+        } else {
+            size_t i = rng() % held.size();
+            map.release(held[i]);
+            taken -= held[i].count;
+            held[i] = held.back();
+            held.pop_back();
+        }
+    }
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return placed;
+}
+
+bool runSeatMapBenchmark() {
+    const int rows = 400, seatsPerRow = 250, seats = rows * seatsPerRow, churnOps = 20000;
+    double bitmapSeconds, naiveSeconds;
+    SeatMap bitmap(seats, seatsPerRow);
+    vector<SeatBlock> fast = runSeatWorkload(bitmap, seats, churnOps, bitmapSeconds);
+    NaiveSeatMap naive(rows, seatsPerRow);
+    vector<SeatBlock> slow = runSeatWorkload(naive, seats, churnOps, naiveSeconds);
+
+    bool match = fast.size() == slow.size() && bitmap.consistent();
+    for (size_t i = 0; match && i < fast.size(); i++) {
+        match = fast[i].row == slow[i].row && fast[i].firstSeat == slow[i].firstSeat &&
+                fast[i].count == slow[i].count;
+    }
+    size_t refused = count_if(fast.begin(), fast.end(), [](const SeatBlock& b) { return b.row < 0; });
+
+    cout << "=== Seat Map Benchmark: " << seats << " seats (" << rows << " rows of " << seatsPerRow
+         << "), " << fast.size() << " searches, " << refused << " refused ===" << endl;
+    cout << left << setw(12) << "Map" << setw(12) << "Time (ms)" << "Searches/s" << endl;
+    cout << fixed << setprecision(2);
+    cout << setw(12) << "bitmap" << setw(12) << bitmapSeconds * 1000 << setprecision(0)
+         << fast.size() / bitmapSeconds << endl;
+    cout << setprecision(2) << setw(12) << "per-seat" << setw(12) << naiveSeconds * 1000
+         << setprecision(0) << slow.size() / naiveSeconds << endl;
+    cout << setprecision(1) << "Speedup: " << naiveSeconds / bitmapSeconds << "x" << endl;
+    cout << (match ? "MATCH" : "MISMATCH: seat maps placed groups differently") << endl;
+    return match;
+}
+
+// === Ticket Store Benchmark ===
+// A cancel-heavy workload: with N live tickets spread over 1000 customers,
+// repeatedly cancel a random one by ticket number and book a replacement,
+// so the store stays at N.
+// TicketStore is timed against the old vector scan-and-erase, which is
+// only run at the sizes where it finishes in reasonable time; both must
+// cancel the same tickets and end with the same live set.
+class VectorTicketStore {
+private:
+    vector<Ticket> tickets;
+    unordered_set<string> names;
+
+public:
+    void add(int ticketId, int eventId, const string& customer, vector<SeatBlock> seats, double cost) {
+        tickets.emplace_back(ticketId, eventId, &*names.insert(customer).first, move(seats), cost);
+    }
+
+    optional<Ticket> remove(int ticketId) {
+        auto it = find_if(tickets.begin(), tickets.end(),
+            [ticketId](const Ticket& t) { return t.getTicketId() == ticketId; });
+        if (it == tickets.end()) return nullopt;
+        Ticket removed = *it;
+        tickets.erase(it);
+        return removed;
+    }
+
+    template <class F>
+    void forEach(F&& fn) const { for (const auto& ticket : tickets) fn(ticket); }
+};
+
+// Cancels per second; `checksum` sums the cancelled and the surviving
+// ticket numbers, weighted by seats, to compare stores by
+template <class Store>
+double runCancelWorkload(Store& store, int live, int cancels, long long& checksum) {
+    mt19937 rng(live);
+    vector<string> customers;
+    for (int c = 0; c < 1000; c++) customers.push_back("Customer " + to_string(c));
+    vector<int> liveIds;
+    int nextId = 1;
+    auto book = [&] {
+        int id = nextId++;
+        store.add(id, 1, customers[rng() % customers.size()], {SeatBlock{0, 0, 1 + id % 4}}, 10.0);
+        liveIds.push_back(id);
+    };
+    for (int i = 0; i < live; i++) book();
+
+    checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < cancels; i++) {
+        size_t pick = rng() % liveIds.size();
+        optional<Ticket> ticket = store.remove(liveIds[pick]);
+        if (ticket) checksum += (long long)ticket->getTicketId() * ticket->getSeatsBooked();
+        else checksum -= 1'000'000'007; // a missing ticket must show up
+        liveIds[pick] = liveIds.back();
+        liveIds.pop_back();
+        book();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    store.forEach([&](const Ticket& t) { checksum += 3LL * t.getTicketId() * t.getSeatsBooked(); });
+    return cancels / seconds;
+}
+
+bool runTicketStoreBenchmark() {
+    const int cancels = 20000;
+    bool allMatch = true;
+    cout << "=== Ticket Store Benchmark: " << cancels << " cancel+rebook per size ===" << endl;
+    cout << left << setw(12) << "Live" << setw(18) << "Slot map (/s)" << setw(18) << "Vector (/s)"
+         << "Result" << endl;
+    for (int live : {1000, 10000, 100000, 1000000}) {
+        long long fastSum, slowSum;
+        TicketStore store;
+        double fast = runCancelWorkload(store, live, cancels, fastSum);
+        cout << fixed << setprecision(0) << setw(12) << live << setw(18) << fast;
+        if (live <= 100000) {
+            VectorTicketStore baseline;
+            double slow = runCancelWorkload(baseline, live, cancels, slowSum);
+            bool match = fastSum == slowSum && store.size() == (size_t)live;
+            cout << setw(18) << slow << (match ? "MATCH" : "MISMATCH") << endl;
+            allMatch = allMatch && match;
+        } else {
+            cout << setw(18) << "-" << "-" << endl;
+        }
+    }
+    return allMatch;
+}
+
+// === Seat Hold Self-Test ===
+// Checks the timer wheel against exact deadlines, the hold lifecycle on a
+// hand-driven clock, then confirms racing the reaper in real time. Seats
+// must always add up: every hold ends as exactly one ticket or exactly one
+// release, never both and never neither.
+bool testTimerWheel() {
+    mt19937_64 rng(7);
+    const uint64_t start = 1'000'000;
+    TimerWheel<int> wheel(start);
+    // Deadlines at every level, some past and some beyond the wheel's range
+    const uint64_t spans[] = {64, 4096, 1 << 18, 1 << 24, 1ull << 26};
+    vector<uint64_t> deadlines;
+    for (int i = 0; i < 200000; i++) {
+        uint64_t deadline = start + rng() % spans[i % 5];
+        if (i % 97 == 0) deadline = start - rng() % 1000;
+        deadlines.push_back(deadline);
+        wheel.schedule(deadline, i);
+    }
+    // Every timer must fire exactly once, in the first advance that
+    // reaches its deadline (a past deadline on the very first tick)
+    vector<int> fired(deadlines.size(), 0);
+    bool ok = true;
+    while (wheel.size() > 0) {
+        uint64_t from = wheel.current(), to = from + 1 + rng() % 20000;
+        wheel.advance(to, [&](int i) {
+            fired[i]++;
+            uint64_t due = max(deadlines[i], start + 1);
+            ok = ok && due <= to && due > from;
+        });
+    }
+    return ok && count(fired.begin(), fired.end(), 1) == (long)fired.size();
+}
+
+bool testHoldLifecycle() {
+    ReservationSystem system;
+    system.addEvent(100, "Holds", "2024-01-01", 40, 10.00);
+    const uint64_t t0 = steadyMillis();
+    bool ok = true;
+
+    // Confirmed in time: the held seats become the ticket's seats
+    optional<SlotHandle> hold = system.holdSeats(100, 4, 1000, t0);
+    ok = ok && hold && system.getAvailableSeats(100) == 36;
+    optional<SlotHandle> booked = system.confirmHold(*hold, "Pat", t0 + 999);
+    optional<Ticket> ticket = booked ? system.getTicket(*booked) : nullopt;
+    ok = ok && ticket && ticket->getSeatsBooked() == 4 && system.getAvailableSeats(100) == 36;
+    ok = ok && !system.confirmHold(*hold, "Pat", t0 + 999) && !system.releaseHold(*hold);
+    ok = ok && system.expireHolds(t0 + 5000) == 0 && system.getAvailableSeats(100) == 36;
+
+    // Expired: not before its deadline, then seats back and no confirming
+    hold = system.holdSeats(100, 6, 1000, t0 + 5000);
+    ok = ok && hold && system.expireHolds(t0 + 5999) == 0 && system.getAvailableSeats(100) == 30;
+    ok = ok && !system.confirmHold(*hold, "Sam", t0 + 6000); // due, though not yet reaped
+    ok = ok && system.expireHolds(t0 + 6000) == 1 && system.getAvailableSeats(100) == 36;
+    ok = ok && !system.confirmHold(*hold, "Sam", t0 + 6000) && !system.releaseHold(*hold);
+
+    // Released early: seats back once, and its timer does nothing later
+    hold = system.holdSeats(100, 10, 1000, t0 + 7000);
+    ok = ok && hold && system.releaseHold(*hold) && system.getAvailableSeats(100) == 36;
+    ok = ok && system.expireHolds(t0 + 9000) == 0 && system.getAvailableSeats(100) == 36;
+
+    // Handles of released holds don't reach holds that reuse their slot
+    optional<SlotHandle> reused = system.holdSeats(100, 2, 1000, t0 + 9000);
+    ok = ok && reused && !system.confirmHold(*hold, "Lee", t0 + 9000);
+    ok = ok && system.confirmHold(*reused, "Lee", t0 + 9000).has_value();
+
+    // A group bigger than a row is seated split over rows
+    hold = system.holdSeats(100, 25, 1000, t0 + 9000);
+    booked = hold ? system.confirmHold(*hold, "Kim", t0 + 9000) : nullopt;
+    ticket = booked ? system.getTicket(*booked) : nullopt;
+    ok = ok && ticket && ticket->getSeatsBooked() == 25 && ticket->getSeats().size() > 1;
+    ok = ok && system.getAvailableSeats(100) == 9;
+
+    // Degenerate sizes: no seats at all, and rows given as zero seats wide
+    system.addEvent(101, "Empty", "2024-01-01", 0, 10.00);
+    system.addEvent(102, "No Rows", "2024-01-01", 3, 10.00, 0);
+    ok = ok && !system.tryBook(101, "Pat", 1) && !system.holdSeats(101, 1, 1000, t0 + 9000);
+    ok = ok && system.tryBook(102, "Pat", 3) && system.getAvailableSeats(102) == 0;
+    ok = ok && system.seatMapConsistent(101) && system.seatMapConsistent(102);
+
+    return ok && system.activeHolds() == 0 && system.seatsSold(100) == 31 &&
+           system.seatMapConsistent(100);
+}
+
+// Buyers confirm holds of 0-20ms while the reaper expires them every 1ms
+bool testHoldRace() {
+    const int capacity = 20000, holdsWanted = 4000, buyers = 8;
+    ReservationSystem system;
+    system.addEvent(100, "Race", "2024-01-01", capacity, 10.00, 50);
+    system.startHoldReaper(1);
+
+    atomic<int> confirmed{0}, seatsConfirmed{0};
+    vector<thread> threads;
+    for (int b = 0; b < buyers; b++) {
+        threads.emplace_back([&, b] {
+            minstd_rand rng(b + 1);
+            for (int i = 0; i < holdsWanted / buyers; i++) {
+                int seats = 1 + rng() % 4;
+                optional<SlotHandle> hold = system.holdSeats(100, seats, rng() % 20);
+                if (!hold) continue;
+                this_thread::sleep_for(chrono::microseconds(rng() % 200));
+                if (system.confirmHold(*hold, "Buyer " + to_string(b))) {
+                    confirmed++;
+                    seatsConfirmed += seats;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    system.expireHolds(steadyMillis() + 100); // anything the reaper hasn't reached yet
+
+    int sold = system.seatsSold(100);
+    cout << "  " << confirmed.load() << " of " << holdsWanted << " holds confirmed before expiry" << endl;
+    return system.activeHolds() == 0 && sold == seatsConfirmed &&
+           system.getAvailableSeats(100) == capacity - sold && system.seatMapConsistent(100);
+}
+
+// A million outstanding holds with TTLs up to ten minutes, all expired
+bool testMillionHolds() {
+    const int count = 1'000'000;
+    ReservationSystem system;
+    system.addEvent(100, "Stadium", "2024-01-01", count, 10.00, 1000);
+    const uint64_t t0 = steadyMillis();
+    minstd_rand rng(11);
+    for (int i = 0; i < count; i++) system.holdSeats(100, 1, 1 + rng() % 600000, t0);
+
+    auto start = chrono::steady_clock::now();
+    size_t halfway = system.expireHolds(t0 + 300000);
+    size_t rest = system.expireHolds(t0 + 600000);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "  " << count << " holds expired in " << fixed << setprecision(1) << ms << " ms" << endl;
+    return halfway + rest == (size_t)count && halfway > count * 0.45 && halfway < count * 0.55 &&
+           system.getAvailableSeats(100) == count && system.seatMapConsistent(100);
+}
+
+bool runHoldSelfTest() {
+    bool allPassed = true;
+    auto check = [&](const string& label, bool ok) {
+        cout << left << setw(22) << label << (ok ? "PASS" : "FAIL") << endl;
+        allPassed = allPassed && ok;
+    };
+    check("timer wheel", testTimerWheel());
+    check("hold lifecycle", testHoldLifecycle());
+    check("confirm vs expiry", testHoldRace());
+    check("million holds", testMillionHolds());
+    return allPassed;
+}
+
+// === Sharded Booking Benchmark ===
+// Producers book 1-4 seats at random across 256 events on sale at once,
+// first through the shared ReservationSystem and then through the sharded
+// system at 1, 2, 4, ... shards up to the core count. Each run must leave
+// every event's seats adding up with its tickets.
+bool runShardBenchmark(int producers) {
+    const int eventCount = 256, seatsPerEvent = 4000, requests = 400000;
+    const int firstEvent = 1000;
+    bool allPassed = true;
+
+    // Times producers submitting requests through book(producer, eventId,
+    // seats) and then `drain`; requests per second
+    auto timeRun = [&](auto&& book, auto&& drain) {
+        latch startGate(producers + 1);
+        vector<thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p] {
+                minstd_rand rng(p + 1);
+                startGate.arrive_and_wait();
+                for (int i = p; i < requests; i += producers) {
+                    book(p, firstEvent + (int)(rng() % eventCount), 1 + (int)(rng() % 4));
+                }
+            });
+        }
+        auto start = chrono::steady_clock::now();
+        startGate.arrive_and_wait();
+        for (auto& t : threads) t.join();
+        drain();
+        return requests / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    vector<string> names;
+    for (int p = 0; p < producers; p++) names.push_back("Buyer " + to_string(p));
+
+    cout << "=== Sharded Booking Benchmark: " << producers << " producers, " << eventCount
+         << " events of " << seatsPerEvent << " seats, " << requests << " requests ===" << endl;
+    cout << left << setw(16) << "System" << setw(16) << "Requests/s" << setw(12) << "Booked" << "Result" << endl;
+    cout << fixed << setprecision(0);
+
+    {
+        ReservationSystem system;
+        for (int e = 0; e < eventCount; e++) {
+            system.addEvent(firstEvent + e, "Event", "2024-01-01", seatsPerEvent, 10.00, 50);
+        }
+        atomic<uint64_t> booked{0};
+        double rate = timeRun([&](int p, int eventId, int seats) {
+            if (system.tryBook(eventId, names[p], seats)) booked.fetch_add(1, memory_order_relaxed);
+        }, [] {});
+        bool ok = true;
+        for (int e = 0; e < eventCount; e++) {
+            int id = firstEvent + e;
+            ok = ok && system.seatsSold(id) + system.getAvailableSeats(id) == seatsPerEvent &&
+                 system.seatMapConsistent(id);
+        }
+        cout << setw(16) << "shared" << setw(16) << rate << setw(12) << booked.load() << (ok ? "PASS" : "FAIL") << endl;
+        allPassed = allPassed && ok;
+    }
+
+    int maxShards = max(4, (int)thread::hardware_concurrency());
+    for (int shardCount = 1; shardCount <= maxShards; shardCount *= 2) {
+        ShardedReservationSystem system(shardCount);
+        for (int e = 0; e < eventCount; e++) system.addEvent(firstEvent + e, seatsPerEvent, 10.00, 50);
+        system.start();
+        double rate = timeRun([&](int p, int eventId, int seats) {
+            system.book(eventId, names[p], seats, nullptr);
+        }, [&] { system.stop(); });
+        bool ok = system.audit();
+        string label = to_string(shardCount) + (shardCount == 1 ? " shard" : " shards");
+        cout << setw(16) << label << setw(16) << rate << setw(12) << system.bookedCount() << (ok ? "PASS" : "FAIL") << endl;
+        allPassed = allPassed && ok;
+    }
+
+    // Round trip: a booking and its cancellation reach the same shard
+    ShardedReservationSystem system(4);
+    system.addEvent(7, 10, 5.00);
+    system.start();
+    optional<Ticket> ticket = system.book(7, "Pat", 3).get();
+    optional<Ticket> cancelled = ticket ? system.cancel(ticket->getTicketId()).get() : nullopt;
+    bool roundTrip = cancelled && cancelled->getTicketId() == ticket->getTicketId() &&
+                     !system.cancel(ticket->getTicketId()).get() && system.book(7, "Sam", 10).get();
+    system.stop();
+    roundTrip = roundTrip && system.audit();
+    cout << "Book/cancel round trip: " << (roundTrip ? "PASS" : "FAIL") << endl;
+    return allPassed && roundTrip;
+}
+
 // === Main ===
-int main() {
+// Command-line modes (otherwise the interactive menu runs):
+//   --flash-sale [BUYERS] [SEATS]  concurrent sell-out stress test
+//                                  (default 2000 buyers, 100000 seats)
+//   --bench-seats                  best-available search on a 100K-seat venue
+//   --bench-cancel                 cancel-heavy workload on the ticket store
+//   --test-holds                   seat hold, confirm and expiry self-test
+//   --bench-shards [PRODUCERS]     shared vs sharded booking across many events
+//                                  (default 4 producers)
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench-shards") {
+        int producers = argc > 2 ? atoi(argv[2]) : 4;
+        if (producers <= 0) {
+            cout << "Error: producers must be positive." << endl;
+            return 1;
+        }
+        return runShardBenchmark(producers) ? 0 : 1;
+    }
+    if (argc > 1 && string(argv[1]) == "--test-holds") {
+        return runHoldSelfTest() ? 0 : 1;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-seats") {
+        return runSeatMapBenchmark() ? 0 : 1;
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-cancel") {
+        return runTicketStoreBenchmark() ? 0 : 1;
+    }
+
+    if (argc > 1 && string(argv[1]) == "--flash-sale") {
+        int buyers = argc > 2 ? atoi(argv[2]) : 2000;
+        int seats = argc > 3 ? atoi(argv[3]) : 100000;
+        if (buyers <= 0 || seats <= 0) {
+            cout << "Error: buyers and seats must be positive." << endl;
+            return 1;
+        }
+        return runFlashSale(buyers, seats) ? 0 : 1;
+    }
+
     ReservationSystem system;
     int choice;
 
     cout << "=== Online Ticket Reservation System ===" << endl;
 
     while (true) {
-        cout << "\n1. View Events\n2. Book Ticket\n3. Cancel Ticket\n4. View All Bookings\n5. Exit\n";
+        cout << "\n1. View Events\n2. Book Ticket\n3. Cancel Ticket\n4. View All Bookings\n5. View My Tickets\n6. Exit\n";
         cout << "Enter Choice: ";
         
         if (!(cin >> choice)) {
@@ -197,7 +1623,7 @@ int main() {
             continue;
         }
 
-        if (choice == 5) break;
+        if (choice == 6) break;
 
         switch (choice) {
             case 1:
@@ -223,6 +1649,14 @@ int main() {
             case 4:
                 system.displayAllBookings();
                 break;
+            case 5: {
+                string name;
+                cout << "Enter Your Name: ";
+                cin.ignore();
+                getline(cin, name);
+                system.displayMyTickets(name);
+                break;
+            }
             default:
                 cout << "Invalid option." << endl;
         }